@@ -9,6 +9,22 @@ if [ "$1" = "editor" ]; then
   if [ "$2" = "run" ]; then
     ./build/editor $3
   fi
+elif [ "$1" = "bench" ]; then
+  echo "building bench"
+  rm -f ./build/bench
+  gcc -std=c99 -O2 -g -o build/bench src/bench.c
+  if [ "$2" = "run" ]; then
+    shift 2
+    ./build/bench "$@"
+  fi
+elif [ "$1" = "render_test" ]; then
+  echo "building render_test"
+  rm -f ./build/render_test
+  gcc -std=c99 -O2 -g -o build/render_test src/render_test.c
+  if [ "$2" = "run" ]; then
+    shift 2
+    ./build/render_test "$@"
+  fi
 else
   echo "not a valid build"
 fi
@@ -2,6 +2,12 @@
 #ifndef BASE_ALL_H
 #define BASE_ALL_H
 
+// glibc hides pthread_barrier_t, clock_gettime and MAP_ANON behind feature macros under -std=c99,
+// and they have to be set before the first system header is pulled in
+#if defined(__gnu_linux__) && !defined(_GNU_SOURCE)
+# define _GNU_SOURCE
+#endif
+
 ///// Context Cracking
 // Development Settings
 #if !defined(ENABLE_ASSERT)
@@ -517,6 +523,7 @@ void scratchReturn(ScratchMem* scratch);
 #define ASCII_ESCAPE    (27)
 #define ASCII_DEL       (127)
 #define ASCII_BACKSPACE (8)
+#define ASCII_CTRL_R    (18)
 
 fn bool stringsEq(String* a, String* b);
 fn bool cStringEqString(str a, String* b);
@@ -560,8 +567,30 @@ TermIOs osStartTUI(bool blocking);
 fn void osEndTUI(TermIOs old_terminal_attributes);
 fn Dim2 osGetTerminalDimensions();
 void osBlitToTerminal(ptr writeable_output_ansi_string, i64 count);
+// never blocks: how many bytes the terminal took (0 when it's full), -1 when it's gone
+i64 osWriteToTerminal(ptr bytes, i64 count);
+void osWaitForTerminalWritable(u64 timeout_us);
 void osReadConsoleInput(u8* buffer, u32 len);
 
+#if OS_LINUX
+// blocks until stdin is readable, the terminal was resized, or a timeout passed
+#define OS_EVENT_INPUT (1 << 0)
+#define OS_EVENT_RESIZE (1 << 1)
+#define OS_EVENT_TIMER (1 << 2)
+#define OS_EVENT_OUTPUT (1 << 3) // the terminal can take more output, only while watched
+typedef struct OsEventLoop {
+  i32 epoll; // -1 if the loop couldn't be set up
+  i32 signal; // SIGWINCH, delivered through a signalfd
+  i32 timer;
+  bool watching_output;
+} OsEventLoop;
+
+fn OsEventLoop osEventLoopCreate(void);
+fn void osEventLoopRelease(OsEventLoop* loop);
+fn void osEventWatchOutput(OsEventLoop* loop, bool watch);
+fn u32 osEventWait(OsEventLoop* loop, u64 timeout_us); // timeout_us 0 waits forever
+#endif
+
 bool osInitNetwork();
 i32 osLanIPAddress();
 
@@ -6,6 +6,10 @@
 #include <time.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
 #include "all.h"
 
 global pthread_barrier_t linux_thread_barrier;
@@ -30,7 +34,7 @@ fn void osBarrierWait(Barrier barrier) {
 fn u64 osTimeMicrosecondsNow() {
   struct timespec ts;
   clock_gettime(CLOCK_MONOTONIC, &ts);
-	return ((u64)ts.tv_sec * 1000000) + ((u64)ts.tv_nsec / 1000000);
+	return ((u64)ts.tv_sec * 1000000) + ((u64)ts.tv_nsec / 1000);
 }
 
 #define MICROSECONDS_PER_SECOND 1000000
@@ -40,6 +44,81 @@ fn void osSleepMicroseconds(u32 t) {
   nanosleep(&ts, NULL);
 }
 
+// Events
+fn void osEventLoopRelease(OsEventLoop* loop) {
+  if (loop->epoll != -1) close(loop->epoll);
+  if (loop->signal != -1) close(loop->signal);
+  if (loop->timer != -1) close(loop->timer);
+  loop->epoll = -1;
+  loop->signal = -1;
+  loop->timer = -1;
+  loop->watching_output = false;
+  sigset_t mask;
+  sigemptyset(&mask);
+  sigaddset(&mask, SIGWINCH);
+  pthread_sigmask(SIG_UNBLOCK, &mask, NULL);
+}
+
+fn OsEventLoop osEventLoopCreate(void) {
+  OsEventLoop result = { .epoll = -1, .signal = -1, .timer = -1 };
+  // SIGWINCH is blocked so it only shows up as a readable signalfd. the mask is per thread,
+  // so this has to run before the caller starts any threads for them to inherit it
+  sigset_t mask;
+  sigemptyset(&mask);
+  sigaddset(&mask, SIGWINCH);
+  pthread_sigmask(SIG_BLOCK, &mask, NULL);
+  result.signal = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+  result.timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  result.epoll = epoll_create1(EPOLL_CLOEXEC);
+
+  i32 fds[3] = { STDIN_FILENO, result.signal, result.timer };
+  u32 events[3] = { OS_EVENT_INPUT, OS_EVENT_RESIZE, OS_EVENT_TIMER };
+  bool ok = result.signal != -1 && result.timer != -1 && result.epoll != -1;
+  for (u32 i = 0; ok && i < 3; i++) {
+    struct epoll_event event = { .events = EPOLLIN, .data.u32 = events[i] };
+    // fails when stdin can't be waited on, e.g. a regular file
+    ok = epoll_ctl(result.epoll, EPOLL_CTL_ADD, fds[i], &event) == 0;
+  }
+  if (!ok) {
+    osEventLoopRelease(&result);
+  }
+  return result;
+}
+
+fn void osEventWatchOutput(OsEventLoop* loop, bool watch) {
+  if (watch == loop->watching_output) return;
+  struct epoll_event event = { .events = EPOLLOUT, .data.u32 = OS_EVENT_OUTPUT };
+  // fails when stdout can't be waited on, e.g. a regular file, which never fills up anyway
+  if (epoll_ctl(loop->epoll, watch ? EPOLL_CTL_ADD : EPOLL_CTL_DEL, STDOUT_FILENO, &event) == 0) {
+    loop->watching_output = watch;
+  }
+}
+
+fn u32 osEventWait(OsEventLoop* loop, u64 timeout_us) {
+  // a one-shot timer, or a disarmed one when waiting forever
+  struct itimerspec timer = {0};
+  timer.it_value.tv_sec = timeout_us / MICROSECONDS_PER_SECOND;
+  timer.it_value.tv_nsec = (timeout_us % MICROSECONDS_PER_SECOND) * NANOSECONDS_PER_MICROSECOND;
+  timerfd_settime(loop->timer, 0, &timer, NULL);
+
+  u32 result = 0;
+  struct epoll_event ready[4];
+  i32 count = epoll_wait(loop->epoll, ready, 4, -1);
+  for (i32 i = 0; i < count; i++) {
+    result |= ready[i].data.u32;
+  }
+  // drain what woke us, stdin is left for osReadConsoleInput
+  if (result & OS_EVENT_RESIZE) {
+    struct signalfd_siginfo info;
+    while (read(loop->signal, &info, sizeof(info)) == sizeof(info)) {}
+  }
+  if (result & OS_EVENT_TIMER) {
+    u64 expirations;
+    read(loop->timer, &expirations, sizeof(expirations));
+  }
+  return result;
+}
+
 // Files
 fn bool osFileExists(String filename) {
   bool result = access((str)filename.bytes, F_OK) == 0;
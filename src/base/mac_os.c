@@ -30,7 +30,7 @@ fn void osBarrierWait(Barrier barrier) {
 fn u64 osTimeMicrosecondsNow() {
   struct timespec ts;
   clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
-	return ((u64)ts.tv_sec * 1000000) + ((u64)ts.tv_nsec / 1000000);
+	return ((u64)ts.tv_sec * 1000000) + ((u64)ts.tv_nsec / 1000);
 }
 
 fn void osSleepMicroseconds(u32 t) {
@@ -58,6 +58,16 @@ fn void arenaInit(Arena* arena) {
   arena->static_size = false;
 }
 
+// reserves `max` bytes of address space up front, but commits lazily like arenaInit
+fn void arenaInitSized(Arena* arena, u64 max) {
+  MemoryZeroStruct(arena, Arena);
+  arena->max = max;
+  arena->memory = osMemoryReserve(arena->max);
+  arena->alloc_position = 0;
+  arena->commit_position = 0;
+  arena->static_size = false;
+}
+
 // WARNING: segfault problems with this approach
 fn void arenaInitStatic(Arena* arena, u64 max) {
   MemoryZeroStruct(arena, Arena);
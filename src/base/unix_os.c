@@ -1,3 +1,5 @@
+#include <errno.h>
+#include <poll.h>
 #include "all.h"
 
 global pthread_key_t linux_thread_context_key;
@@ -59,15 +61,19 @@ TermIOs osStartTUI(bool blocking) {
   old_terminal_attributes = terminal_attributes;
   terminal_attributes.c_lflag &= ~(ICANON | ECHO); // dont echo keypresses, dont wait for carriage return
   tcsetattr(STDOUT_FILENO, TCSANOW, &terminal_attributes);
+  fflush(stdout);
   if (!blocking) {
     fcntl(STDIN_FILENO, F_SETFL, O_NONBLOCK); // non-blocking input mode
+    // and output, usually the same tty. osBlitToTerminal still blocks, osWriteToTerminal doesn't
+    fcntl(STDOUT_FILENO, F_SETFL, fcntl(STDOUT_FILENO, F_GETFL) | O_NONBLOCK);
   }
-  fflush(stdout);
   return old_terminal_attributes;
 }
 
 fn void osEndTUI(TermIOs old_terminal_attributes) {
   tcsetattr(STDOUT_FILENO, TCSANOW, &old_terminal_attributes);
+  // back to blocking, for the printf below and for whoever gets the tty next
+  fcntl(STDOUT_FILENO, F_SETFL, fcntl(STDOUT_FILENO, F_GETFL) & ~O_NONBLOCK);
 
   // cleanup terminal TUI incantations
   printf("\033[?1049l");
@@ -105,6 +111,19 @@ void osBlitToTerminal(ptr writeable_output_ansi_string, i64 count) {
   fcntl(STDOUT_FILENO, F_SETFL, flags);
 }
 
+i64 osWriteToTerminal(ptr bytes, i64 count) {
+  i64 result = write(STDOUT_FILENO, bytes, count);
+  if (result < 0) {
+    result = errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR ? 0 : -1;
+  }
+  return result;
+}
+
+void osWaitForTerminalWritable(u64 timeout_us) {
+  struct pollfd fd = { .fd = STDOUT_FILENO, .events = POLLOUT };
+  poll(&fd, 1, (timeout_us + 999) / 1000);
+}
+
 bool osInitNetwork() { return true; }
 
 void osReadConsoleInput(u8* buffer, u32 len) {
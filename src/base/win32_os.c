@@ -176,6 +176,19 @@ void osBlitToTerminal(ptr writeable_output_ansi_string, i64 count) {
 	assert(written == count);
 }
 
+i64 osWriteToTerminal(ptr bytes, i64 count) {
+	HANDLE hStdout = GetStdHandle(STD_OUTPUT_HANDLE);
+	DWORD written = 0;
+	if (!WriteConsole(hStdout, bytes, count, &written, NULL)) {
+		return -1;
+	}
+	return written;
+}
+
+void osWaitForTerminalWritable(u64 timeout_us) {
+	// WriteConsole doesn't leave anything behind to wait for
+}
+
 bool osInitNetwork() {
 	WSADATA wsaData;
 
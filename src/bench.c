@@ -0,0 +1,1838 @@
+#include "base/impl.c"
+#include "string_chunk.c"
+#include "tree_render.c"
+#include "tree_store.c"
+#include "journal.c"
+#include <stdio.h>
+#if OS_LINUX
+#include <pty.h>
+#include <poll.h>
+#include <sys/wait.h>
+#endif
+
+///// #DEFINES
+#define BENCH_TREE_NODE_COUNT (1000000)
+#define BENCH_TREE_FANOUT (16)
+#define BENCH_RENDER_FUNCTIONS (2000)
+#define BENCH_RENDER_STATEMENTS (24)
+#define BENCH_RENDER_WIDTH (64)
+#define BENCH_RENDER_FRAMES (20)
+#define BENCH_INSERT_MIN_CHILDREN (12500)
+#define BENCH_INSERT_MAX_CHILDREN (200000)
+#define BENCH_CHURN_EDITS (200000)
+#define BENCH_SNAPSHOT_EDITS (20000)
+#define BENCH_SNAPSHOT_TAKES (1000000)
+#define BENCH_JOURNAL_ROUNDS (4000)
+#define BENCH_JOURNAL_CAPPED_BYTES KB(64)
+#define BENCH_PASTE_NODES (10000)
+#define BENCH_PASTE_REPEATS (20)
+#define BENCH_VIEW_FUNCTIONS (30)
+#define BENCH_LAYOUT_FRAMES (100000)
+#define BENCH_LAYOUT_EDITS (10000)
+#define BENCH_VIEWPORT_SCROLLS (10000)
+#define BENCH_ANSI_FRAMES (2000)
+#define BENCH_ANSI_PARTIAL_PERCENT (5)
+#define BENCH_DIFF_WIDTH (800)
+#define BENCH_DIFF_HEIGHT (300)
+#define BENCH_DIFF_ROUNDS (200)
+#define BENCH_MEMORY_BUFFER_WIDTH (800) // the editor's MAX_SCREEN_WIDTH/HEIGHT
+#define BENCH_MEMORY_BUFFER_HEIGHT (300)
+#define BENCH_MEMORY_CONTENT_ROWS (25)
+#define BENCH_MEMORY_FRAMES (2000)
+#define BENCH_LOOP_KEYS (200)
+#define BENCH_LOOP_IDLE_US (2000000)
+#define BENCH_SCROLL_LINES (5000)
+#define BENCH_SCROLL_FRAMES (2000)
+#define BENCH_BAND_FRAMES (200)
+#define BENCH_SLOW_KEYS (300)
+#define BENCH_SLOW_BYTES_PER_MS (512) // what the slow terminal reads, ~2 MB/s
+#define BENCH_VIEW_FRAMES (2000)
+#define BENCH_VIEW_SCREEN_WIDTH (200)
+#define BENCH_VIEW_SCREEN_HEIGHT (60)
+
+///// TYPES
+typedef struct Benchmark {
+  str name;
+  void (*run)(void);
+} Benchmark;
+
+// what CNode looked like before the hot/cold split, kept here only to measure against
+typedef struct CNodeInline {
+  NodeType type;
+  u32 id;
+  u32 generation;
+  u32 child_count;
+  u32 flags;
+  NodeHandle parent;
+  NodeHandle first_child;
+  NodeHandle next_sibling;
+  NodeHandle prev_sibling;
+  Pointu32 render_start;
+  union {
+    CFnDetails function;
+    String numeric_literal;
+  };
+} CNodeInline;
+
+///// functions()
+fn f64 benchSecondsSince(u64 start_us) {
+  return (f64)(osTimeMicrosecondsNow() - start_us) / 1000000.0;
+}
+
+// xorshift32, so runs are repeatable
+fn u32 benchRandom(u32* state) {
+  u32 x = *state;
+  x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+  *state = x;
+  return x;
+}
+
+// fills `tree` breadth-first so that no parent ends up with more than `fanout` children.
+// depth 1 are functions, below that blocks and return statements, and returns hold literals.
+// literals are leaves, so they get skipped when picking the next parent.
+fn void buildSyntheticTree(CTree* tree, u32 node_count, u32 fanout) {
+  Arena arena = {0};
+  arenaInit(&arena);
+  NodeHandle* handles = arenaAllocArray(&arena, NodeHandle, node_count);
+  handles[0] = tree->root;
+  u32 parent_i = 0;
+  u32 children_of_parent = 0;
+  for (u32 i = 1; i < node_count; i++) {
+    if (children_of_parent == fanout) {
+      do {
+        parent_i += 1;
+      } while (nodeFromHandle(tree, handles[parent_i])->type == NodeTypeNumericLiteral);
+      children_of_parent = 0;
+    }
+    NodeType parent_type = nodeFromHandle(tree, handles[parent_i])->type;
+    NodeType type = NodeTypeReturn;
+    if (parent_type == NodeTypeRoot) {
+      type = NodeTypeFunction;
+    } else if (parent_type == NodeTypeReturn) {
+      type = NodeTypeNumericLiteral;
+    } else if (i % 4 == 0) {
+      type = NodeTypeBlock;
+    }
+    handles[i] = addNode(tree, type, handles[parent_i]);
+    children_of_parent += 1;
+  }
+  arenaFree(&arena);
+}
+
+fn void benchTreeBuild(void) {
+  u64 start = osTimeMicrosecondsNow();
+  CTree tree = cTreeCreate();
+  NodeHandle first = addNode(&tree, NodeTypeFunction, tree.root);
+  buildSyntheticTree(&tree, BENCH_TREE_NODE_COUNT - 1, BENCH_TREE_FANOUT);
+  f64 seconds = benchSecondsSince(start);
+
+  // the first handle has to survive every growth of the pool
+  assert(isNodeHandleValid(&tree, first));
+  assert(nodeFromHandle(&tree, first)->type == NodeTypeFunction);
+
+  u32 live = tree.length - 1;
+  printf("tree_build: %u nodes in %.3f s, %.0f nodes/s, %.1f bytes/node (sizeof(CNode) = %lu)\n",
+    live, seconds, live / seconds, (f64)cTreeBytesCommitted(&tree) / live, (unsigned long)sizeof(CNode));
+  cTreeRelease(&tree);
+}
+
+fn void benchTreeMemory(void) {
+  CTree tree = cTreeCreate();
+  buildSyntheticTree(&tree, BENCH_TREE_NODE_COUNT, BENCH_TREE_FANOUT);
+  u32 live = tree.length - 1;
+  u64 hot_bytes = tree.arena.commit_position;
+  u64 cold_bytes = tree.functions.arena.commit_position + tree.numeric_literals.arena.commit_position;
+  printf("tree_memory: %u nodes (%u functions, %u literals)\n",
+    live, tree.functions.length - 1, tree.numeric_literals.length - 1);
+  printf("  hot  CNode %lu bytes (%.1f per cache line), %.1f bytes/node committed\n",
+    (unsigned long)sizeof(CNode), 64.0 / sizeof(CNode), (f64)hot_bytes / live);
+  printf("  cold payloads %.1f bytes/node committed (CFnDetails %lu, String %lu)\n",
+    (f64)cold_bytes / live, (unsigned long)sizeof(CFnDetails), (unsigned long)sizeof(String));
+  printf("  total %.1f bytes/node, inline-union layout would be %lu bytes/node\n",
+    (f64)(hot_bytes + cold_bytes) / live, (unsigned long)sizeof(CNodeInline));
+  cTreeRelease(&tree);
+}
+
+// preorder walk over first_child/next_sibling links, the same pattern renderNode follows
+#define PREORDER_WALK(nodes, root_index, visited) \
+  stmnt( \
+    u32 i = (root_index); \
+    while (i != NODE_NIL) { \
+      visited += 1; \
+      if (nodes[i].first_child != NODE_NIL) { i = nodeHandleIndex(nodes[i].first_child); continue; } \
+      while (i != (root_index) && nodes[i].next_sibling == NODE_NIL) { i = nodeHandleIndex(nodes[i].parent); } \
+      i = i == (root_index) ? NODE_NIL : nodeHandleIndex(nodes[i].next_sibling); \
+    } \
+  )
+
+fn void benchTreeWalk(void) {
+  CTree tree = cTreeCreate();
+  buildSyntheticTree(&tree, BENCH_TREE_NODE_COUNT, BENCH_TREE_FANOUT);
+
+  // mirror the exact same links into the old inline-union layout
+  Arena inline_arena = {0};
+  arenaInitSized(&inline_arena, (u64)tree.length * sizeof(CNodeInline) + MB(1));
+  CNodeInline* inline_nodes = arenaAllocArray(&inline_arena, CNodeInline, tree.length);
+  for (u32 i = 0; i < tree.length; i++) {
+    inline_nodes[i].type = tree.nodes[i].type;
+    inline_nodes[i].parent = tree.nodes[i].parent;
+    inline_nodes[i].first_child = tree.nodes[i].first_child;
+    inline_nodes[i].next_sibling = tree.nodes[i].next_sibling;
+    inline_nodes[i].prev_sibling = tree.nodes[i].prev_sibling;
+  }
+
+  u32 root_index = nodeHandleIndex(tree.root);
+  u64 hot_visited = 0;
+  u64 start = osTimeMicrosecondsNow();
+  PREORDER_WALK(tree.nodes, root_index, hot_visited);
+  f64 hot_seconds = benchSecondsSince(start);
+
+  u64 inline_visited = 0;
+  start = osTimeMicrosecondsNow();
+  PREORDER_WALK(inline_nodes, root_index, inline_visited);
+  f64 inline_seconds = benchSecondsSince(start);
+
+  assert(hot_visited == inline_visited);
+  printf("tree_walk: %llu nodes, hot/cold %.2f ns/node, inline-union %.2f ns/node (%.1fx)\n",
+    hot_visited, hot_seconds * 1e9 / hot_visited, inline_seconds * 1e9 / inline_visited, inline_seconds / hot_seconds);
+  arenaFree(&inline_arena);
+  cTreeRelease(&tree);
+}
+
+// `function_count` functions of BENCH_RENDER_STATEMENTS `return 0;`s each, returns the last function
+fn NodeHandle buildRenderTree(CTree* tree, StringArena* strings, u32 function_count) {
+  String name = { .bytes = "fn", .length = 2, .capacity = 3 };
+  NodeHandle fn_handle = NODE_NIL;
+  for (u32 f = 0; f < function_count; f++) {
+    fn_handle = addNode(tree, NodeTypeFunction, tree->root);
+    CFnDetails* details = nodeFunction(tree, nodeFromHandle(tree, fn_handle));
+    details->name = allocStringChunkList(strings, name);
+    details->return_type = allocStringChunkList(strings, DEFAULT_RETURN_TYPE);
+    for (u32 r = 0; r < BENCH_RENDER_STATEMENTS; r++) {
+      NodeHandle ret_handle = addNode(tree, NodeTypeReturn, fn_handle);
+      String* literal = nodeNumericLiteral(tree, nodeFromHandle(tree, addNode(tree, NodeTypeNumericLiteral, ret_handle)));
+      literal->bytes = "0";
+      literal->length = 1;
+      literal->capacity = 2;
+    }
+  }
+  return fn_handle;
+}
+
+fn void benchRenderTraversal(void) {
+  Arena arena = {0};
+  arenaInit(&arena);
+  StringArena string_arena = {0};
+  arenaInit(&string_arena.a);
+  string_arena.mutex = newMutex();
+
+  CTree tree = cTreeCreate();
+  buildRenderTree(&tree, &string_arena, BENCH_RENDER_FUNCTIONS);
+  TreeLayout layout = layoutCreate();
+  layoutSync(&layout, &tree);
+
+  // a viewport tall enough to hold the whole tree, so nothing gets culled
+  u32 rows = layout.nodes[nodeHandleIndex(tree.root)].height;
+  Viewport vp = {
+    .pixels = arenaAllocArray(&arena, Pixel, (u64)rows * BENCH_RENDER_WIDTH),
+    .width = BENCH_RENDER_WIDTH,
+    .height = rows,
+    .layout = &layout,
+  };
+
+  u32 live = tree.length - 1;
+  u64 start = osTimeMicrosecondsNow();
+  for (u32 i = 0; i < BENCH_RENDER_FRAMES; i++) {
+    renderView(&vp, &tree, tree.root, NULL);
+  }
+  f64 seconds = benchSecondsSince(start);
+  printf("render_traversal: %u nodes x %u frames, %.2f ms/frame, %.2f ns/node\n",
+    live, BENCH_RENDER_FRAMES, seconds * 1000 / BENCH_RENDER_FRAMES, seconds * 1e9 / ((f64)live * BENCH_RENDER_FRAMES));
+  layoutRelease(&layout);
+  arenaFree(&arena);
+  arenaFree(&string_arena.a);
+  cTreeRelease(&tree);
+}
+
+typedef enum InsertKind {
+  InsertKindAppend,
+  InsertKindPrepend,
+  InsertKindBefore,
+  InsertKindAfter,
+  InsertKind_Count
+} InsertKind;
+global str INSERT_KIND_STRINGS[InsertKind_Count] = {"append", "prepend", "before", "after"};
+
+// inserts N children under a single parent (the "50k top-level functions" case).
+// before/after keep inserting next to the same sibling so they land mid-list.
+// every op is O(1), so ns/insert should stay flat as N doubles.
+fn void benchTreeInsert(void) {
+  printf("tree_insert: ns/insert of N children under one parent\n");
+  printf("  %8s", "N");
+  for (u32 k = 0; k < InsertKind_Count; k++) {
+    printf(" %9s", INSERT_KIND_STRINGS[k]);
+  }
+  printf("\n");
+  for (u32 n = BENCH_INSERT_MIN_CHILDREN; n <= BENCH_INSERT_MAX_CHILDREN; n *= 2) {
+    printf("  %8u", n);
+    for (u32 k = 0; k < InsertKind_Count; k++) {
+      CTree tree = cTreeCreate();
+      NodeHandle anchor = addNode(&tree, NodeTypeFunction, tree.root);
+      addNode(&tree, NodeTypeFunction, tree.root);
+      u64 start = osTimeMicrosecondsNow();
+      for (u32 i = 0; i < n; i++) {
+        switch ((InsertKind)k) {
+          case InsertKindAppend: addNode(&tree, NodeTypeIncomplete, tree.root); break;
+          case InsertKindPrepend: addNodeFirstChild(&tree, NodeTypeIncomplete, tree.root); break;
+          case InsertKindBefore: addNodeBeforeSibling(&tree, NodeTypeIncomplete, tree.root, anchor); break;
+          case InsertKindAfter: addNodeAfterSibling(&tree, NodeTypeIncomplete, tree.root, anchor); break;
+          case InsertKind_Count: break;
+        }
+      }
+      f64 seconds = benchSecondsSince(start);
+      assert(nodeFromHandle(&tree, tree.root)->child_count == n + 2);
+      printf(" %9.1f", seconds * 1e9 / n);
+      cTreeRelease(&tree);
+    }
+    printf("\n");
+  }
+}
+
+fn void benchTreeLookup(void) {
+  CTree tree = cTreeCreate();
+  buildSyntheticTree(&tree, BENCH_TREE_NODE_COUNT, BENCH_TREE_FANOUT);
+
+  // random ids, so lookups land all over the table instead of walking it in order
+  u32 rng = 2463534242u;
+  u64 checksum = 0;
+  u64 start = osTimeMicrosecondsNow();
+  for (u32 i = 0; i < BENCH_TREE_NODE_COUNT; i++) {
+    u32 id = benchRandom(&rng) % tree.next_id;
+    CNode* node = nodeFromHandle(&tree, handleFromId(&tree, id));
+    assert(node->id == id);
+    checksum += node->type;
+  }
+  f64 seconds = benchSecondsSince(start);
+  printf("tree_lookup: %u random id lookups on %u nodes, %.1f ns/lookup (checksum %llu)\n",
+    BENCH_TREE_NODE_COUNT, tree.length - 1, seconds * 1e9 / BENCH_TREE_NODE_COUNT, checksum);
+  cTreeRelease(&tree);
+
+  // one node deleted and re-added over and over: the slot is refilled until its generation
+  // wraps, and the ids run past what the id map reserves up front
+  tree = cTreeCreate();
+  NodeHandle first = addNode(&tree, NodeTypeIncomplete, tree.root);
+  NodeHandle churned = first;
+  start = osTimeMicrosecondsNow();
+  for (u32 i = 0; i < NODE_POOL_MAX_NODES; i++) {
+    deleteSubtree(&tree, churned, NULL);
+    churned = addNode(&tree, NodeTypeIncomplete, tree.root);
+    assert(nodeFromHandle(&tree, first) == &tree.nodes[NODE_NIL]);
+  }
+  seconds = benchSecondsSince(start);
+  assert(nodeFromHandle(&tree, handleFromId(&tree, tree.next_id - 1)) == nodeFromHandle(&tree, churned));
+  printf("  %u deletes and re-adds of one node, %.1f ns each, %u slots used\n",
+    NODE_POOL_MAX_NODES, seconds * 1e9 / NODE_POOL_MAX_NODES, tree.length - 1);
+  cTreeRelease(&tree);
+}
+
+fn void printLayoutStats(str label, CTree* tree) {
+  CTreeLayoutStats stats = cTreeLayoutStats(tree);
+  u64 visited = 0;
+  u32 root_index = nodeHandleIndex(tree->root);
+  u64 start = osTimeMicrosecondsNow();
+  PREORDER_WALK(tree->nodes, root_index, visited);
+  f64 seconds = benchSecondsSince(start);
+  printf("  %-8s %7u live %7u free of %7u slots, %5.1f%% fragmented, %5.1f%% of preorder steps sequential, walk %.2f ns/node\n",
+    label, stats.live, stats.free, stats.slots, stats.fragmentation * 100, stats.preorder_sequential * 100, seconds * 1e9 / visited);
+}
+
+// an editing session's worth of churn: delete random subtrees and leave incomplete
+// nodes lying around at random spots, then compact.
+fn void benchTreeCompact(void) {
+  CTree tree = cTreeCreate();
+  buildSyntheticTree(&tree, BENCH_TREE_NODE_COUNT, BENCH_TREE_FANOUT);
+  printf("tree_compact: %u edits on a %u node tree\n", BENCH_CHURN_EDITS, tree.length - 1);
+  printLayoutStats("built", &tree);
+
+  u32 rng = 2463534242u;
+  for (u32 i = 0; i < BENCH_CHURN_EDITS; i++) {
+    NodeHandle target = NODE_NIL;
+    while (target == NODE_NIL || target == tree.root) {
+      target = handleFromId(&tree, benchRandom(&rng) % tree.next_id);
+    }
+    if (i % 2 == 0) {
+      deleteSubtree(&tree, target, NULL);
+    } else {
+      addNodeAfterSibling(&tree, NodeTypeIncomplete, nodeFromHandle(&tree, target)->parent, target);
+    }
+  }
+  printLayoutStats("churned", &tree);
+
+  u64 start = osTimeMicrosecondsNow();
+  cTreeCompact(&tree, NULL, 0);
+  f64 seconds = benchSecondsSince(start);
+  printLayoutStats("compact", &tree);
+  printf("  compaction took %.2f ms\n", seconds * 1000);
+  cTreeRelease(&tree);
+}
+
+fn void benchTreePreorder(void) {
+  CTree tree = cTreeCreate();
+  buildSyntheticTree(&tree, BENCH_TREE_NODE_COUNT, BENCH_TREE_FANOUT);
+  CTreePreorder preorder = preorderCreate();
+
+  u64 start = osTimeMicrosecondsNow();
+  bool built = preorderSync(&preorder, &tree);
+  f64 build_seconds = benchSecondsSince(start);
+  start = osTimeMicrosecondsNow();
+  bool rebuilt = preorderSync(&preorder, &tree); // nothing changed, nothing to do
+  f64 noop_seconds = benchSecondsSince(start);
+  assert(built && !rebuilt);
+
+  // count return statements: chasing links vs scanning the flat array
+  u32 linked_returns = 0;
+  start = osTimeMicrosecondsNow();
+  for (NodeHandle h = tree.root; h != NODE_NIL; h = nextNodePreorder(&tree, h, tree.root)) {
+    linked_returns += nodeFromHandle(&tree, h)->type == NodeTypeReturn;
+  }
+  f64 linked_seconds = benchSecondsSince(start);
+  u32 flat_returns = 0;
+  start = osTimeMicrosecondsNow();
+  for (u32 i = 0; i < preorder.length; i++) {
+    flat_returns += nodeFromHandle(&tree, preorder.nodes[i])->type == NodeTypeReturn;
+  }
+  f64 flat_seconds = benchSecondsSince(start);
+  assert(linked_returns == flat_returns);
+
+  // visit only the top-level functions, skipping each one's body in O(1)
+  u32 functions = 0;
+  start = osTimeMicrosecondsNow();
+  for (u32 i = 1; i < preorder.length; i += preorder.subtree_sizes[i]) {
+    assert(preorder.depths[i] == 1);
+    functions += 1;
+  }
+  f64 skip_seconds = benchSecondsSince(start);
+  assert(functions == nodeFromHandle(&tree, tree.root)->child_count);
+
+  // one edit makes it stale again
+  addNode(&tree, NodeTypeIncomplete, tree.root);
+  start = osTimeMicrosecondsNow();
+  rebuilt = preorderSync(&preorder, &tree);
+  f64 rebuild_seconds = benchSecondsSince(start);
+  assert(rebuilt);
+  assert(preorder.subtree_sizes[0] == tree.length - 1);
+
+  printf("tree_preorder: %u nodes\n", preorder.length);
+  printf("  build %.2f ms, unchanged sync %.3f us, rebuild after one edit %.2f ms\n",
+    build_seconds * 1000, noop_seconds * 1e6, rebuild_seconds * 1000);
+  printf("  full walk: linked %.2f ns/node, flat scan %.2f ns/node\n",
+    linked_seconds * 1e9 / preorder.length, flat_seconds * 1e9 / preorder.length);
+  printf("  top-level skip: %u functions in %.3f us\n", functions, skip_seconds * 1e6);
+  preorderRelease(&preorder);
+  cTreeRelease(&tree);
+}
+
+// counts the nodes reachable from `root`, so an old snapshot can be checked against the tree it came from
+fn u32 countSnapshotNodes(TreeStore* store, StoreRef root) {
+  Arena arena = {0};
+  arenaInit(&arena);
+  StoreRef* stack = arenaAllocArray(&arena, StoreRef, store->node_count);
+  u32 top = 0;
+  u32 result = 0;
+  stack[top++] = root;
+  while (top > 0) {
+    StoreNode* node = storeNode(store, stack[--top]);
+    StoreRef* children = storeChildren(store, node);
+    for (u32 i = 0; i < node->child_count; i++) {
+      stack[top++] = children[i];
+    }
+    result += 1;
+  }
+  arenaFree(&arena);
+  return result;
+}
+
+// hold a snapshot, make a session's worth of edits, and check the snapshot never noticed
+fn void benchTreeSnapshot(void) {
+  StringArena strings = {0};
+  arenaInit(&strings.a);
+  strings.mutex = newMutex();
+  CTree tree = cTreeCreate();
+  buildSyntheticTree(&tree, BENCH_TREE_NODE_COUNT, BENCH_TREE_FANOUT);
+  u32 built_nodes = tree.length - 1;
+  String name = { .bytes = "before", .length = 6, .capacity = 7 };
+  NodeHandle named = nodeFromHandle(&tree, tree.root)->first_child;
+  nodeFunction(&tree, nodeFromHandle(&tree, named))->name = allocStringChunkList(&strings, name);
+
+  u64 start = osTimeMicrosecondsNow();
+  TreeStore store = treeStoreCreate(&tree);
+  f64 create_seconds = benchSecondsSince(start);
+  u64 created_bytes = treeStoreBytesUsed(&store);
+
+  start = osTimeMicrosecondsNow();
+  TreeSnapshot before = {0};
+  for (u32 i = 0; i < BENCH_SNAPSHOT_TAKES; i++) {
+    before = treeSnapshotTake(&store);
+  }
+  f64 take_seconds = benchSecondsSince(start);
+
+  // rename the first function, then retype it so its payload goes back to the free list
+  // for the next function to reuse: the held snapshot keeps the name it was taken with
+  String renamed = { .bytes = "after", .length = 5, .capacity = 6 };
+  CFnDetails* details = nodeFunction(&tree, nodeFromHandle(&tree, named));
+  releaseStringChunkList(&strings, &details->name);
+  details->name = allocStringChunkList(&strings, renamed);
+  treeStoreCommitNode(&store, &tree, named);
+  releaseNodeStrings(&tree, nodeFromHandle(&tree, named), &strings);
+  changeNodeType(&tree, named, NodeTypeIncomplete);
+  treeStoreCommitNode(&store, &tree, named);
+  addNode(&tree, NodeTypeFunction, tree.root);
+  treeStoreCommitNode(&store, &tree, tree.root);
+  StoreNode* held = storeNode(&store, storeChildren(&store, storeNode(&store, before.root))[0]);
+  assert(held->type == NodeTypeFunction && held->text_count >= 2);
+  assert(held->texts[0].length == name.length);
+  assert(memcmp(held->texts[0].bytes, name.bytes, name.length) == 0);
+
+  // a third each: insert a sibling, delete a leaf, retype a node in place
+  u32 rng = 2463534242u;
+  f64 commit_seconds = 0;
+  for (u32 i = 0; i < BENCH_SNAPSHOT_EDITS; i++) {
+    NodeHandle target = NODE_NIL;
+    while (target == NODE_NIL || target == tree.root) {
+      target = handleFromId(&tree, benchRandom(&rng) % tree.next_id);
+    }
+    CNode* node = nodeFromHandle(&tree, target);
+    NodeHandle committed = node->parent;
+    if (i % 3 == 0) {
+      addNodeAfterSibling(&tree, NodeTypeIncomplete, node->parent, target);
+    } else if (i % 3 == 1 && node->child_count == 0) {
+      deleteSubtree(&tree, target, NULL);
+    } else if (node->type == NodeTypeBlock || node->type == NodeTypeStatement) {
+      changeNodeType(&tree, target, node->type == NodeTypeBlock ? NodeTypeStatement : NodeTypeBlock);
+      committed = target;
+    } else {
+      changeNodeType(&tree, target, NodeTypeIncomplete);
+      committed = target;
+    }
+    start = osTimeMicrosecondsNow();
+    treeStoreCommitNode(&store, &tree, committed);
+    commit_seconds += benchSecondsSince(start);
+  }
+  u64 edit_bytes = treeStoreBytesUsed(&store) - created_bytes;
+
+  TreeSnapshot after = treeSnapshotTake(&store);
+  assert(after.version == before.version + BENCH_SNAPSHOT_EDITS + 3);
+  u32 before_nodes = countSnapshotNodes(&store, before.root);
+  u32 after_nodes = countSnapshotNodes(&store, after.root);
+  assert(before_nodes == built_nodes);
+  assert(after_nodes == tree.length - 1 - tree.free_count);
+  treeStoreRelease(&store);
+  cTreeRelease(&tree);
+
+  // a chain as deep as the whole tree, written in one go
+  tree = cTreeCreate();
+  NodeHandle deepest = tree.root;
+  for (u32 i = 0; i < BENCH_TREE_NODE_COUNT; i++) {
+    deepest = addNode(&tree, NodeTypeBlock, deepest);
+  }
+  start = osTimeMicrosecondsNow();
+  store = treeStoreCreate(&tree);
+  f64 chain_seconds = benchSecondsSince(start);
+  assert(countSnapshotNodes(&store, treeSnapshotTake(&store).root) == BENCH_TREE_NODE_COUNT + 1);
+
+  printf("tree_snapshot: %u node tree, %u edits\n", built_nodes, BENCH_SNAPSHOT_EDITS);
+  printf("  initial version %.2f ms, %.1f MB (%.1f bytes/node)\n",
+    create_seconds * 1000, (f64)created_bytes / MB(1), (f64)created_bytes / built_nodes);
+  printf("  snapshot take %.1f ns\n", take_seconds * 1e9 / BENCH_SNAPSHOT_TAKES);
+  printf("  commit %.2f us/edit, %.1f bytes/edit (a deep copy would be %.1f MB)\n",
+    commit_seconds * 1e6 / BENCH_SNAPSHOT_EDITS, (f64)edit_bytes / BENCH_SNAPSHOT_EDITS, (f64)created_bytes / MB(1));
+  printf("  held snapshot still sees %u nodes, latest sees %u\n", before_nodes, after_nodes);
+  printf("  initial version of a %u deep chain %.2f ms\n", BENCH_TREE_NODE_COUNT, chain_seconds * 1000);
+  treeStoreRelease(&store);
+  cTreeRelease(&tree);
+  arenaFree(&strings.a);
+}
+
+// node count plus every function's text, so a round trip through undo/redo can be checked
+fn u64 treeFingerprint(CTree* tree) {
+  u64 result = 0;
+  for (NodeHandle h = tree->root; h != NODE_NIL; h = nextNodePreorder(tree, h, tree->root)) {
+    CNode* node = nodeFromHandle(tree, h);
+    result += 1 + ((u64)node->type << 32);
+    if (node->type == NodeTypeFunction) {
+      CFnDetails* function = nodeFunction(tree, node);
+      result += (function->name.total_size << 8) + (function->return_type.total_size << 16);
+    }
+  }
+  return result;
+}
+
+// each round: add a function, type its name, fix a typo, pick a return type, and
+// now and then delete an earlier one. returns the number of keystrokes.
+fn u32 journalSession(Journal* journal, CTree* tree, StringArena* strings, u32 rounds) {
+  String name = { .bytes = "compute_total", .length = 13, .capacity = 14 };
+  String type = { .bytes = "unsigned long", .length = 13, .capacity = 14 };
+  u32 keystrokes = 0;
+  NodeHandle prev = NODE_NIL;
+  for (u32 i = 0; i < rounds; i++) {
+    NodeHandle node = journalInsertNode(journal, tree, strings, NodeTypeIncomplete, tree->root, prev);
+    journalChangeType(journal, tree, strings, node, NodeTypeFunction);
+    for (u32 c = 0; c < name.length; c++) {
+      String key = { .bytes = name.bytes + c, .length = 1, .capacity = 1 };
+      journalAppendText(journal, tree, strings, node, TextFieldFunctionName, key);
+    }
+    journalDeleteText(journal, tree, strings, node, TextFieldFunctionName);
+    journalDeleteText(journal, tree, strings, node, TextFieldFunctionName);
+    journalReplaceText(journal, tree, strings, node, TextFieldFunctionReturnType, type);
+    journalBreakRun(journal);
+    keystrokes += 2 + name.length + 2 + 1;
+    prev = node;
+    if (i % 8 == 7) {
+      prev = nodeFromHandle(tree, node)->prev_sibling;
+      journalDeleteNode(journal, tree, strings, node);
+      keystrokes += 1;
+    }
+  }
+  return keystrokes;
+}
+
+fn void benchJournalUndo(void) {
+  StringArena strings = {0};
+  arenaInit(&strings.a);
+  strings.mutex = newMutex();
+  CTree tree = cTreeCreate();
+  Journal journal = journalCreate(GB(1));
+  u64 initial = treeFingerprint(&tree);
+
+  u32 keystrokes = journalSession(&journal, &tree, &strings, BENCH_JOURNAL_ROUNDS);
+  u32 steps = journal.done - journal.first;
+  u64 edited = treeFingerprint(&tree);
+  // the deleted functions are still allocated, detached, for undo. a preorder walks past them
+  CTreePreorder preorder = preorderCreate();
+  preorderSync(&preorder, &tree);
+  assert(preorder.length < tree.length - 1 - tree.free_count);
+  preorderRelease(&preorder);
+
+  u64 start = osTimeMicrosecondsNow();
+  while (journalUndo(&journal, &tree, &strings) != NODE_NIL);
+  f64 undo_seconds = benchSecondsSince(start);
+  assert(treeFingerprint(&tree) == initial);
+  start = osTimeMicrosecondsNow();
+  while (journalRedo(&journal, &tree, &strings) != NODE_NIL);
+  f64 redo_seconds = benchSecondsSince(start);
+  assert(treeFingerprint(&tree) == edited);
+
+  printf("journal_undo: %u keystrokes, %u undo steps\n", keystrokes, steps);
+  printf("  %.1f bytes/keystroke including kept-alive deleted nodes\n", (f64)journal.bytes_used / keystrokes);
+  printf("  undo all %.3f ms (%.1f ns/step), redo all %.3f ms (%.1f ns/step)\n",
+    undo_seconds * 1000, undo_seconds * 1e9 / steps, redo_seconds * 1000, redo_seconds * 1e9 / steps);
+  journalRelease(&journal, &tree, &strings);
+  cTreeRelease(&tree);
+
+  // the same session under a small cap: old history goes, the newest stays undoable
+  tree = cTreeCreate();
+  journal = journalCreate(BENCH_JOURNAL_CAPPED_BYTES);
+  journalSession(&journal, &tree, &strings, BENCH_JOURNAL_ROUNDS);
+  assert(journal.bytes_used <= BENCH_JOURNAL_CAPPED_BYTES);
+  u32 capped_steps = journal.done - journal.first;
+  start = osTimeMicrosecondsNow();
+  while (journalUndo(&journal, &tree, &strings) != NODE_NIL);
+  undo_seconds = benchSecondsSince(start);
+  printf("  capped at %u KB: kept the newest %u steps, undo all %.3f ms\n",
+    BENCH_JOURNAL_CAPPED_BYTES / KB(1), capped_steps, undo_seconds * 1000);
+  journalRelease(&journal, &tree, &strings);
+  cTreeRelease(&tree);
+
+  arenaFree(&strings.a);
+}
+
+// `count` nodes under `parent`, breadth-first with up to `fanout` children each.
+// every eighth one is a function with a name and return type, the rest are blocks.
+fn NodeHandle buildNamedSubtree(CTree* tree, StringArena* strings, u32 count, u32 fanout) {
+  String name = { .bytes = "accumulate_partial_sums", .length = 23, .capacity = 24 };
+  String type = { .bytes = "unsigned long long", .length = 18, .capacity = 19 };
+  Arena arena = {0};
+  arenaInit(&arena);
+  NodeHandle* handles = arenaAllocArray(&arena, NodeHandle, count);
+  handles[0] = addNode(tree, NodeTypeFunction, tree->root);
+  u32 parent = 0;
+  for (u32 i = 1; i < count; i++) {
+    if (nodeFromHandle(tree, handles[parent])->child_count == fanout) {
+      parent += 1;
+    }
+    handles[i] = addNode(tree, i % 8 == 0 ? NodeTypeFunction : NodeTypeBlock, handles[parent]);
+  }
+  for (u32 i = 0; i < count; i++) {
+    CNode* node = nodeFromHandle(tree, handles[i]);
+    if (node->type == NodeTypeFunction) {
+      CFnDetails* function = nodeFunction(tree, node);
+      function->name = allocStringChunkList(strings, name);
+      function->return_type = allocStringChunkList(strings, type);
+    }
+  }
+  NodeHandle result = handles[0];
+  arenaFree(&arena);
+  return result;
+}
+
+// types and string bytes of a subtree in preorder, so two copies can be compared
+fn u64 subtreeFingerprint(CTree* tree, NodeHandle subtree_root) {
+  u64 result = 14695981039346656037ull;
+  for (NodeHandle h = subtree_root; h != NODE_NIL; h = nextNodePreorder(tree, h, subtree_root)) {
+    CNode* node = nodeFromHandle(tree, h);
+    result = (result ^ (node->type + ((u64)node->child_count << 8))) * 1099511628211ull;
+    if (node->type == NodeTypeFunction) {
+      CFnDetails* function = nodeFunction(tree, node);
+      StringChunkList lists[2] = { function->name, function->return_type };
+      for (u32 l = 0; l < 2; l++) {
+        StringChunk* chunk = lists[l].first;
+        for (u64 i = 0; i < lists[l].total_size; i++) {
+          if (i > 0 && i % STRING_CHUNK_PAYLOAD_SIZE == 0) chunk = chunk->next;
+          result = (result ^ ((u8*)(chunk + 1))[i % STRING_CHUNK_PAYLOAD_SIZE]) * 1099511628211ull;
+        }
+      }
+    }
+  }
+  return result;
+}
+
+// the way a duplicate would be built without a clip: one addNode and one string
+// round trip per node, appended after `prev` under the root
+fn NodeHandle duplicateNodeByNode(CTree* tree, StringArena* strings, NodeHandle subtree_root) {
+  Arena scratch = {0};
+  arenaInit(&scratch);
+  NodeHandle result = addNodeAfterSibling(tree, nodeFromHandle(tree, subtree_root)->type, tree->root, subtree_root);
+  NodeHandle copy = result;
+  NodeHandle h = subtree_root;
+  while (true) {
+    CNode* node = nodeFromHandle(tree, h);
+    if (node->type == NodeTypeFunction) {
+      CFnDetails* from = nodeFunction(tree, node);
+      CFnDetails* to = nodeFunction(tree, nodeFromHandle(tree, copy));
+      to->name = allocStringChunkList(strings, stringChunkToString(&scratch, from->name));
+      to->return_type = allocStringChunkList(strings, stringChunkToString(&scratch, from->return_type));
+    }
+    if (node->first_child != NODE_NIL) {
+      h = node->first_child;
+      copy = addNode(tree, nodeFromHandle(tree, h)->type, copy);
+      continue;
+    }
+    while (h != subtree_root && nodeFromHandle(tree, h)->next_sibling == NODE_NIL) {
+      h = nodeFromHandle(tree, h)->parent;
+      copy = nodeFromHandle(tree, copy)->parent;
+    }
+    if (h == subtree_root) break;
+    h = nodeFromHandle(tree, h)->next_sibling;
+    copy = addNode(tree, nodeFromHandle(tree, h)->type, nodeFromHandle(tree, copy)->parent);
+  }
+  arenaFree(&scratch);
+  return result;
+}
+
+typedef struct SubtreeCopyRound {
+  f64 naive_seconds;
+  f64 paste_seconds;
+  f32 naive_nodes_sequential; // share of preorder steps that land on the very next slot
+  f32 paste_nodes_sequential;
+  f32 naive_chunks_sequential; // same for the string chunks, in the order a walk reads them
+  f32 paste_chunks_sequential;
+} SubtreeCopyRound;
+
+fn void subtreeLocality(CTree* tree, NodeHandle subtree_root, f32* nodes_sequential, f32* chunks_sequential) {
+  u32 steps = 0, sequential = 0, chunk_steps = 0, chunk_sequential = 0;
+  CNode* prev = NULL;
+  StringChunk* prev_chunk = NULL;
+  for (NodeHandle h = subtree_root; h != NODE_NIL; h = nextNodePreorder(tree, h, subtree_root)) {
+    CNode* node = nodeFromHandle(tree, h);
+    if (prev != NULL) {
+      steps += 1;
+      sequential += node == prev + 1;
+    }
+    prev = node;
+    if (node->type == NodeTypeFunction) {
+      CFnDetails* function = nodeFunction(tree, node);
+      StringChunk* firsts[2] = { function->name.first, function->return_type.first };
+      for (u32 l = 0; l < 2; l++) {
+        for (StringChunk* chunk = firsts[l]; chunk != NULL; chunk = chunk->next) {
+          if (prev_chunk != NULL) {
+            chunk_steps += 1;
+            chunk_sequential += (u8*)chunk == (u8*)prev_chunk + STRING_CHUNK_SIZE;
+          }
+          prev_chunk = chunk;
+        }
+      }
+    }
+  }
+  *nodes_sequential = steps > 0 ? (f32)sequential / steps : 1;
+  *chunks_sequential = chunk_steps > 0 ? (f32)chunk_sequential / chunk_steps : 1;
+}
+
+// times BENCH_PASTE_REPEATS copies of `original` each way, checks them, then deletes them
+// and compacts, so the next round reuses memory that's already been faulted in
+fn SubtreeCopyRound timeSubtreeCopies(CTree* tree, StringArena* strings, CTreeClip* clip, NodeHandle* original) {
+  SubtreeCopyRound result = {0};
+  u64 fingerprint = subtreeFingerprint(tree, *original);
+  NodeHandle copies[2 * BENCH_PASTE_REPEATS];
+  u64 start = osTimeMicrosecondsNow();
+  for (u32 i = 0; i < BENCH_PASTE_REPEATS; i++) {
+    copies[i] = duplicateNodeByNode(tree, strings, *original);
+  }
+  result.naive_seconds = benchSecondsSince(start) / BENCH_PASTE_REPEATS;
+  start = osTimeMicrosecondsNow();
+  for (u32 i = 0; i < BENCH_PASTE_REPEATS; i++) {
+    copies[BENCH_PASTE_REPEATS + i] = cTreePaste(tree, clip, strings, tree->root, *original);
+  }
+  result.paste_seconds = benchSecondsSince(start) / BENCH_PASTE_REPEATS;
+  subtreeLocality(tree, copies[BENCH_PASTE_REPEATS - 1], &result.naive_nodes_sequential, &result.naive_chunks_sequential);
+  subtreeLocality(tree, copies[2 * BENCH_PASTE_REPEATS - 1], &result.paste_nodes_sequential, &result.paste_chunks_sequential);
+  for (u32 i = 0; i < arrayLen(copies); i++) {
+    assert(subtreeFingerprint(tree, copies[i]) == fingerprint);
+    deleteSubtree(tree, copies[i], strings);
+  }
+  NodeHandle* external[] = { original };
+  cTreeCompact(tree, external, arrayLen(external));
+  return result;
+}
+
+fn void benchSubtreePaste(void) {
+  StringArena strings = {0};
+  arenaInit(&strings.a);
+  strings.mutex = newMutex();
+  CTree tree = cTreeCreate();
+  NodeHandle original = buildNamedSubtree(&tree, &strings, BENCH_PASTE_NODES, BENCH_TREE_FANOUT);
+
+  CTreeClip clip = clipCreate();
+  u64 start = osTimeMicrosecondsNow();
+  cTreeYank(&tree, original, &clip);
+  f64 yank_seconds = benchSecondsSince(start);
+
+  // the first round mostly measures page faults on fresh memory, the second the copying itself
+  SubtreeCopyRound cold = timeSubtreeCopies(&tree, &strings, &clip, &original);
+  SubtreeCopyRound warm = timeSubtreeCopies(&tree, &strings, &clip, &original);
+
+  // the way 'p' runs it: through the journal, so it undoes in one step
+  Journal journal = journalCreate(GB(1));
+  start = osTimeMicrosecondsNow();
+  NodeHandle pasted = journalPaste(&journal, &tree, &strings, &clip, tree.root, original);
+  f64 journal_paste_seconds = benchSecondsSince(start);
+  assert(subtreeFingerprint(&tree, pasted) == subtreeFingerprint(&tree, original));
+  start = osTimeMicrosecondsNow();
+  journalUndo(&journal, &tree, &strings);
+  f64 undo_seconds = benchSecondsSince(start);
+  assert(nodeFromHandle(&tree, pasted)->parent == NODE_NIL);
+  journalRelease(&journal, &tree, &strings);
+
+  printf("subtree_paste: %u node subtree, %u functions, %llu string chunks\n",
+    clip.node_count, clip.function_count, clip.chunk_count);
+  printf("  yank %.3f ms\n", yank_seconds * 1000);
+  printf("  cold: node by node %.3f ms, paste %.3f ms per copy\n", cold.naive_seconds * 1000, cold.paste_seconds * 1000);
+  printf("  warm: node by node %.3f ms, paste %.3f ms per copy (%.1fx)\n",
+    warm.naive_seconds * 1000, warm.paste_seconds * 1000, warm.naive_seconds / warm.paste_seconds);
+  printf("  warm copy layout: node by node %.1f%% of nodes / %.1f%% of string chunks sequential, paste %.1f%% / %.1f%%\n",
+    warm.naive_nodes_sequential * 100, warm.naive_chunks_sequential * 100,
+    warm.paste_nodes_sequential * 100, warm.paste_chunks_sequential * 100);
+  printf("  journaled paste %.3f ms, undo %.2f us\n", journal_paste_seconds * 1000, undo_seconds * 1e6);
+  clipRelease(&clip);
+  cTreeRelease(&tree);
+  arenaFree(&strings.a);
+}
+
+// two panes over one tree, the whole file and one function, drawn the way the editor does
+fn void drawViewFrame(TuiState* tui, CTree* tree, TreeLayout* layout, ViewCache* caches, NodeHandle* roots) {
+  u32 pane_width = BENCH_VIEW_SCREEN_WIDTH / 2;
+  layoutSync(layout, tree);
+  for (u32 v = 0; v < 2; v++) {
+    viewCacheSync(&caches[v], tree, layout, roots[v], 0, pane_width, BENCH_VIEW_SCREEN_HEIGHT);
+    viewCacheBlit(&caches[v], tui, v*pane_width, 0);
+  }
+}
+
+fn void benchViewCache(void) {
+  Arena arena = {0};
+  arenaInit(&arena);
+  StringArena strings = {0};
+  arenaInit(&strings.a);
+  strings.mutex = newMutex();
+
+  CTree tree = cTreeCreate();
+  NodeHandle last_function = buildRenderTree(&tree, &strings, BENCH_VIEW_FUNCTIONS);
+
+  TuiState tui = tuiInit(&arena, BENCH_VIEW_SCREEN_WIDTH * BENCH_VIEW_SCREEN_HEIGHT);
+  tui.screen_dimensions.width = BENCH_VIEW_SCREEN_WIDTH;
+  tui.screen_dimensions.height = BENCH_VIEW_SCREEN_HEIGHT;
+  TreeLayout layout = layoutCreate();
+  ViewCache caches[2] = { viewCacheCreate(), viewCacheCreate() };
+  NodeHandle roots[2] = { tree.root, last_function };
+  drawViewFrame(&tui, &tree, &layout, caches, roots); // first touch of the cache memory
+
+  // every frame changes the tree, so every pane re-renders: what drawing cost before caching
+  u64 start = osTimeMicrosecondsNow();
+  for (u32 i = 0; i < BENCH_VIEW_FRAMES; i++) {
+    markNodeChanged(&tree, last_function);
+    drawViewFrame(&tui, &tree, &layout, caches, roots);
+  }
+  f64 changed_seconds = benchSecondsSince(start);
+
+  start = osTimeMicrosecondsNow();
+  for (u32 i = 0; i < BENCH_VIEW_FRAMES; i++) {
+    drawViewFrame(&tui, &tree, &layout, caches, roots);
+  }
+  f64 unchanged_seconds = benchSecondsSince(start);
+
+  // switching which view is in which pane reuses both layouts
+  start = osTimeMicrosecondsNow();
+  for (u32 i = 0; i < BENCH_VIEW_FRAMES; i++) {
+    ViewCache swapped_caches[2] = { caches[1], caches[0] };
+    NodeHandle swapped_roots[2] = { roots[1], roots[0] };
+    drawViewFrame(&tui, &tree, &layout, swapped_caches, swapped_roots);
+  }
+  f64 switch_seconds = benchSecondsSince(start);
+
+  printf("view_cache: %u nodes, 2 panes of %ux%u\n", tree.length - 1, BENCH_VIEW_SCREEN_WIDTH / 2, BENCH_VIEW_SCREEN_HEIGHT);
+  printf("  tree changed every frame: %.1f us/frame\n", changed_seconds * 1e6 / BENCH_VIEW_FRAMES);
+  printf("  unchanged: %.1f us/frame, switching panes: %.1f us/frame\n",
+    unchanged_seconds * 1e6 / BENCH_VIEW_FRAMES, switch_seconds * 1e6 / BENCH_VIEW_FRAMES);
+  viewCacheRelease(&caches[0]);
+  viewCacheRelease(&caches[1]);
+  layoutRelease(&layout);
+  arenaFree(&arena);
+  arenaFree(&strings.a);
+  cTreeRelease(&tree);
+}
+
+fn void benchTreeLayout(void) {
+  Arena arena = {0};
+  arenaInit(&arena);
+  StringArena strings = {0};
+  arenaInit(&strings.a);
+  strings.mutex = newMutex();
+  CTree tree = cTreeCreate();
+  NodeHandle last_function = buildRenderTree(&tree, &strings, BENCH_RENDER_FUNCTIONS);
+  u32 live = tree.length - 1;
+
+  TreeLayout layout = layoutCreate();
+  u64 start = osTimeMicrosecondsNow();
+  layoutSync(&layout, &tree);
+  f64 full_seconds = benchSecondsSince(start);
+  u32 rows = layout.nodes[nodeHandleIndex(tree.root)].height;
+  assert(rows == BENCH_RENDER_FUNCTIONS * (BENCH_RENDER_STATEMENTS + 3));
+  // where the editor puts the cursor: the last function is one function's height from the end
+  Pointu32 last_at = layoutPosition(&layout, &tree, last_function, tree.root);
+  assert(last_at.x == 0 && last_at.y == rows - (BENCH_RENDER_STATEMENTS + 3));
+
+  // before: every frame walked and drew the whole tree
+  Viewport vp = {
+    .pixels = arenaAllocArray(&arena, Pixel, (u64)rows * BENCH_RENDER_WIDTH),
+    .width = BENCH_RENDER_WIDTH,
+    .height = rows,
+    .layout = &layout,
+  };
+  start = osTimeMicrosecondsNow();
+  for (u32 i = 0; i < BENCH_RENDER_FRAMES; i++) {
+    renderView(&vp, &tree, tree.root, NULL);
+  }
+  f64 render_seconds = benchSecondsSince(start) / BENCH_RENDER_FRAMES;
+
+  start = osTimeMicrosecondsNow();
+  for (u32 i = 0; i < BENCH_LAYOUT_FRAMES; i++) {
+    assert(!layoutSync(&layout, &tree));
+  }
+  f64 unchanged_seconds = benchSecondsSince(start) / BENCH_LAYOUT_FRAMES;
+
+  // typing into some node: only it and its ancestors get re-measured
+  u32 seed = 1;
+  start = osTimeMicrosecondsNow();
+  for (u32 i = 0; i < BENCH_LAYOUT_EDITS; i++) {
+    NodeHandle edited = handleFromId(&tree, 1 + benchRandom(&seed) % live);
+    markNodeChanged(&tree, edited);
+    layoutSync(&layout, &tree);
+  }
+  f64 edit_seconds = benchSecondsSince(start) / BENCH_LAYOUT_EDITS;
+
+  // a new top-level node re-stacks every function under the root
+  start = osTimeMicrosecondsNow();
+  for (u32 i = 0; i < BENCH_LAYOUT_EDITS; i++) {
+    addNode(&tree, NodeTypeIncomplete, tree.root);
+    layoutSync(&layout, &tree);
+  }
+  f64 insert_seconds = benchSecondsSince(start) / BENCH_LAYOUT_EDITS;
+
+  printf("tree_layout: %u nodes\n", live);
+  printf("  full render every frame (before): %.3f ms/frame\n", render_seconds * 1000);
+  printf("  first layout: %.3f ms, unchanged frame: %.1f ns\n", full_seconds * 1000, unchanged_seconds * 1e9);
+  printf("  edit a node: %.2f us, insert under the root (%u+ siblings): %.2f us\n",
+    edit_seconds * 1e6, BENCH_RENDER_FUNCTIONS, insert_seconds * 1e6);
+  layoutRelease(&layout);
+  arenaFree(&arena);
+  arenaFree(&strings.a);
+  cTreeRelease(&tree);
+}
+
+// one frame at each of BENCH_VIEWPORT_SCROLLS random scroll positions, returns seconds per frame
+fn f64 timeViewportFrames(Viewport* vp, CTree* tree, RowIndex* rows, u32 content_height) {
+  u32 seed = 7;
+  u64 start = osTimeMicrosecondsNow();
+  for (u32 i = 0; i < BENCH_VIEWPORT_SCROLLS; i++) {
+    vp->top = benchRandom(&seed) % (content_height - vp->height);
+    MemoryZero(vp->pixels, (u64)vp->width * vp->height * sizeof(Pixel));
+    renderView(vp, tree, tree->root, rows);
+  }
+  return benchSecondsSince(start) / BENCH_VIEWPORT_SCROLLS;
+}
+
+fn void benchViewportRender(void) {
+  Arena arena = {0};
+  arenaInit(&arena);
+  StringArena strings = {0};
+  arenaInit(&strings.a);
+  strings.mutex = newMutex();
+  Viewport vp = {
+    .pixels = arenaAllocArray(&arena, Pixel, BENCH_VIEW_SCREEN_WIDTH * BENCH_VIEW_SCREEN_HEIGHT),
+    .width = BENCH_VIEW_SCREEN_WIDTH,
+    .height = BENCH_VIEW_SCREEN_HEIGHT,
+  };
+
+  printf("viewport_render: a %ux%u window scrolled to random rows\n", BENCH_VIEW_SCREEN_WIDTH, BENCH_VIEW_SCREEN_HEIGHT);
+  // the same screen over trees 10x apart: the frame shouldn't notice
+  for (u32 functions = BENCH_RENDER_FUNCTIONS / 10; functions <= BENCH_RENDER_FUNCTIONS * 10; functions *= 10) {
+    CTree tree = cTreeCreate();
+    buildRenderTree(&tree, &strings, functions);
+    TreeLayout layout = layoutCreate();
+    layoutSync(&layout, &tree);
+    vp.layout = &layout;
+    u32 content_height = layout.nodes[nodeHandleIndex(tree.root)].height;
+
+    RowIndex rows = rowIndexCreate();
+    u64 start = osTimeMicrosecondsNow();
+    rowIndexSync(&rows, &tree, &layout, tree.root);
+    f64 index_seconds = benchSecondsSince(start);
+
+    // every row has to come out the same whether the walk seeks or starts from the top
+    Pixel* seeked = arenaAllocArray(&arena, Pixel, BENCH_VIEW_SCREEN_WIDTH * BENCH_VIEW_SCREEN_HEIGHT);
+    vp.top = content_height / 2 + 3;
+    MemoryZero(vp.pixels, BENCH_VIEW_SCREEN_WIDTH * BENCH_VIEW_SCREEN_HEIGHT * sizeof(Pixel));
+    renderView(&vp, &tree, tree.root, &rows);
+    MemoryCopy(seeked, vp.pixels, BENCH_VIEW_SCREEN_WIDTH * BENCH_VIEW_SCREEN_HEIGHT * sizeof(Pixel));
+    MemoryZero(vp.pixels, BENCH_VIEW_SCREEN_WIDTH * BENCH_VIEW_SCREEN_HEIGHT * sizeof(Pixel));
+    renderView(&vp, &tree, tree.root, NULL);
+    assert(memcmp(seeked, vp.pixels, BENCH_VIEW_SCREEN_WIDTH * BENCH_VIEW_SCREEN_HEIGHT * sizeof(Pixel)) == 0 && "seeking changed what got drawn");
+    arenaDealloc(&arena, BENCH_VIEW_SCREEN_WIDTH * BENCH_VIEW_SCREEN_HEIGHT * sizeof(Pixel));
+
+    f64 seek_seconds = timeViewportFrames(&vp, &tree, &rows, content_height);
+    f64 scan_seconds = timeViewportFrames(&vp, &tree, NULL, content_height);
+    printf("  %7u nodes, %7u rows: %.1f us/frame seeking, %.1f us/frame walking from the top, row index build %.2f ms\n",
+      tree.length - 1, content_height, seek_seconds * 1e6, scan_seconds * 1e6, index_seconds * 1000);
+    rowIndexRelease(&rows);
+    layoutRelease(&layout);
+    cTreeRelease(&tree);
+  }
+  arenaFree(&arena);
+  arenaFree(&strings.a);
+}
+
+global u64 bench_ansi_flushed_bytes = 0;
+fn void benchAnsiFlush(u8* bytes, u64 length) {
+  (void)bytes;
+  bench_ansi_flushed_bytes += length;
+}
+
+// a screen of text with runs of color, blanks and a background band here and there
+fn void fillAnsiFrame(Pixel* pixels, u32 count, u32 seed) {
+  for (u32 i = 0; i < count; i++) {
+    u32 r = (i * 2654435761u) ^ seed;
+    MemoryZeroStruct(&pixels[i], Pixel);
+    if (i % 7 == 0) continue; // blank cells carry no style, the terminal wouldn't show it
+    pixels[i].bytes[0] = 'a' + (r % 26);
+    pixels[i].foreground = (i / 9) % 4 == 0 ? 0 : (u8)(r >> 8) % 16;
+    pixels[i].background = (i / 40) % 5 == 0 ? (u8)(r >> 16) : 0;
+    pixels[i].attributes = (i / 13) % 6 == 0 ? PIXEL_BOLD : (i / 13) % 6 == 1 ? PIXEL_UNDERLINE|PIXEL_BOLD : 0;
+  }
+}
+
+fn u32 parseAnsiNumber(u8* bytes, u64* at) {
+  u32 result = 0;
+  while (bytes[*at] >= '0' && bytes[*at] <= '9') {
+    result = result*10 + (bytes[(*at)++] - '0');
+  }
+  return result;
+}
+
+// plays the encoder's output back onto `screen`, the way a terminal would
+fn void replayAnsi(Pixel* screen, Dim2 sd, u8* bytes, u64 length) {
+  u32 x = 0, y = 0;
+  u8 fg = 0, bg = 0, attributes = 0;
+  u32 region_top = 0, region_bottom = sd.height - 1;
+  for (u64 at = 0; at < length;) {
+    if (bytes[at] == '\r' || bytes[at] == '\n') {
+      if (bytes[at] == '\r') x = 0; else y += 1;
+      at += 1;
+      continue;
+    }
+    if (bytes[at] != '\033') {
+      Pixel* cell = &screen[x + y*sd.width];
+      MemoryZeroStruct(cell, Pixel);
+      cell->bytes[0] = bytes[at++];
+      cell->foreground = fg;
+      cell->background = bg;
+      cell->attributes = attributes;
+      x += 1;
+      continue;
+    }
+    at += 2; // ESC [
+    // the final byte says what the numbers before it mean
+    u64 end = at;
+    while (bytes[end] == ';' || bytes[end] == '?' || (bytes[end] >= '0' && bytes[end] <= '9')) end += 1;
+    if (bytes[at] == '?') {
+      // synchronized updates, nothing to draw
+    } else if (bytes[end] == 'r') {
+      region_top = at == end ? 0 : parseAnsiNumber(bytes, &at) - 1;
+      at += 1;
+      region_bottom = at >= end ? (u32)sd.height - 1 : parseAnsiNumber(bytes, &at) - 1;
+      x = 0;
+      y = 0;
+    } else if (bytes[end] == 'S' || bytes[end] == 'T') {
+      // rows move up (S) or down (T) inside the region, the ones they leave are blank
+      u32 lines = parseAnsiNumber(bytes, &at);
+      u32 kept = region_bottom - region_top + 1 - lines;
+      u32 from = bytes[end] == 'S' ? region_top + lines : region_top;
+      u32 to = bytes[end] == 'S' ? region_top : region_top + lines;
+      u32 vacated = bytes[end] == 'S' ? region_top + kept : region_top;
+      memmove(screen + to * sd.width, screen + from * sd.width, (u64)kept * sd.width * sizeof(Pixel));
+      MemoryZero(screen + vacated * sd.width, (u64)lines * sd.width * sizeof(Pixel));
+    } else if (bytes[end] >= 'A' && bytes[end] <= 'D') {
+      // relative moves, ESC[A is one cell
+      u32 n = at == end ? 1 : parseAnsiNumber(bytes, &at);
+      if (bytes[end] == 'A') y -= n;
+      if (bytes[end] == 'B') y += n;
+      if (bytes[end] == 'C') x += n;
+      if (bytes[end] == 'D') x -= n;
+    } else if (bytes[end] == 'J') {
+      MemoryZero(screen, (u64)sd.width * sd.height * sizeof(Pixel));
+    } else if (bytes[end] == 'f') {
+      y = parseAnsiNumber(bytes, &at) - 1;
+      at += 1;
+      x = parseAnsiNumber(bytes, &at) - 1;
+    } else {
+      assert(bytes[end] == 'm');
+      assert(parseAnsiNumber(bytes, &at) == 0 && "every style change starts from a reset");
+      fg = 0;
+      bg = 0;
+      attributes = 0;
+      while (bytes[at] == ';') {
+        at += 1;
+        u32 which = parseAnsiNumber(bytes, &at);
+        if (which == 1) { attributes |= PIXEL_BOLD; continue; }
+        if (which == 4) { attributes |= PIXEL_UNDERLINE; continue; }
+        at += 3; // ;5;
+        u32 color = parseAnsiNumber(bytes, &at);
+        if (which == 38) fg = color; else bg = color;
+      }
+    }
+    at = end + 1;
+  }
+}
+
+// a blank cell and a space with no background or underline look the same on a terminal,
+// and the encoder prints one for the other when it's cheaper than moving the cursor
+fn bool pixelLooksBlank(Pixel* pixel) {
+  return pixel->bytes[0] == 0
+    || (pixel->bytes[0] == ' ' && pixel->bytes[1] == 0 && pixel->background == 0 && !(pixel->attributes & PIXEL_UNDERLINE));
+}
+
+fn bool screensLookAlike(Pixel* a, Pixel* b, u32 cells) {
+  for (u32 i = 0; i < cells; i++) {
+    bool alike = pixelLooksBlank(&a[i]) ? pixelLooksBlank(&b[i]) : isPixelEq(a[i], b[i]);
+    if (!alike) return false;
+  }
+  return true;
+}
+
+fn void benchAnsiEncode(void) {
+  Arena arena = {0};
+  arenaInit(&arena);
+  Dim2 sd = { .width = BENCH_VIEW_SCREEN_WIDTH, .height = BENCH_VIEW_SCREEN_HEIGHT };
+  u32 cells = sd.width * sd.height;
+  Pixel* old = arenaAllocArray(&arena, Pixel, cells);
+  Pixel* next = arenaAllocArray(&arena, Pixel, cells);
+  Pixel* replayed = arenaAllocArray(&arena, Pixel, cells);
+  Pos2 cursor = {0};
+  // big enough that the correctness checks below see each frame in one piece
+  AnsiEncoder enc = ansiEncoderCreate(&arena, MB(1), benchAnsiFlush);
+  FrameDiff diff = frameDiffCreate(&arena, cells);
+
+  // full redraws
+  fillAnsiFrame(next, cells, 1);
+  ansiEncodeFrame(&enc, old, next, sd, NULL, cursor);
+  replayAnsi(replayed, sd, enc.bytes, enc.length);
+  assert(screensLookAlike(replayed, next, cells) && "a full redraw didn't reproduce the frame");
+  ansiFlush(&enc);
+  u64 flushed_before = enc.flushed;
+  Pixel* frames[2] = { next, replayed };
+  fillAnsiFrame(frames[1], cells, 2);
+  u64 start = osTimeMicrosecondsNow();
+  for (u32 f = 0; f < BENCH_ANSI_FRAMES; f++) {
+    ansiEncodeFrame(&enc, old, frames[f % 2], sd, NULL, cursor);
+    ansiFlush(&enc);
+  }
+  f64 full_seconds = benchSecondsSince(start) / BENCH_ANSI_FRAMES;
+  u64 full_bytes = (enc.flushed - flushed_before) / BENCH_ANSI_FRAMES;
+
+  // partial redraws: a few percent of the cells change between frames
+  fillAnsiFrame(old, cells, 1);
+  MemoryCopy(replayed, old, cells * sizeof(Pixel));
+  u32 changed = cells * BENCH_ANSI_PARTIAL_PERCENT / 100;
+  u64 encode_us = 0;
+  flushed_before = enc.flushed;
+  for (u32 f = 0; f < BENCH_ANSI_FRAMES; f++) {
+    MemoryCopy(next, old, cells * sizeof(Pixel));
+    for (u32 i = 0; i < changed; i++) {
+      Pixel* cell = &next[(i*7919 + f*104729) % cells];
+      cell->bytes[0] = 'A' + f % 26;
+      cell->foreground = f % 16;
+    }
+    start = osTimeMicrosecondsNow();
+    frameDiff(&diff, old, next, sd, NULL, NULL);
+    ansiEncodeFrame(&enc, old, next, sd, &diff, cursor);
+    encode_us += osTimeMicrosecondsNow() - start;
+    if (f % 100 == 0) {
+      replayAnsi(replayed, sd, enc.bytes, enc.length);
+      assert(screensLookAlike(replayed, next, cells) && "a partial redraw didn't reproduce the frame");
+    } else {
+      MemoryCopy(replayed, next, cells * sizeof(Pixel));
+    }
+    ansiFlush(&enc);
+    Pixel* swap = old;
+    old = next;
+    next = swap;
+  }
+  f64 partial_seconds = (f64)encode_us / 1e6 / BENCH_ANSI_FRAMES;
+  u64 partial_bytes = (enc.flushed - flushed_before) / BENCH_ANSI_FRAMES;
+
+  printf("ansi_encode: %ux%u screen\n", sd.width, sd.height);
+  printf("  full redraw: %.1f us/frame, %.1f M cells/s, %llu bytes/frame\n",
+    full_seconds * 1e6, cells / full_seconds / 1e6, full_bytes);
+  printf("  partial redraw (%u%% changed): %.1f us/frame, %.1f M cells/s scanned, %llu bytes/frame\n",
+    BENCH_ANSI_PARTIAL_PERCENT, partial_seconds * 1e6, cells / partial_seconds / 1e6, partial_bytes);
+  arenaFree(&arena);
+}
+
+// what printfBufferAndSwap used to do before encoding: a quick equality check that stops at the
+// first difference, then a clearing pass and a rendering pass that each compare every cell
+fn u32 threePassScan(Pixel* old, Pixel* next, u32 cells) {
+  bool all_equal = true;
+  for (u32 i = 0; i < cells; i++) {
+    if (!isPixelEq(old[i], next[i])) {
+      all_equal = false;
+      break;
+    }
+  }
+  if (all_equal) return 0;
+  u32 found = 0;
+  for (u32 i = 0; i < cells; i++) {
+    bool needs_clearing = (next[i].bytes[0] == 0 && old[i].bytes[0] != 0)
+                       || (next[i].background == 0 && old[i].background != 0)
+                       || (next[i].foreground == 0 && old[i].foreground != 0);
+    found += needs_clearing;
+  }
+  for (u32 i = 0; i < cells; i++) {
+    found += !isPixelEq(old[i], next[i]);
+  }
+  return found;
+}
+
+fn u32 frameDiffCells(FrameDiff* diff) {
+  u32 cells = 0;
+  for (u32 i = 0; i < diff->length; i++) {
+    cells += diff->spans[i].end - diff->spans[i].start;
+  }
+  return cells;
+}
+
+typedef struct DiffKernel {
+  str name;
+  void (*diff_row)(FrameDiff* diff, Pixel* old, Pixel* next, u32 width, u16 row);
+} DiffKernel;
+
+fn f64 timeFrameDiff(FrameDiff* diff, Pixel* old, Pixel* next, Dim2 sd, u64* old_hashes, u64* next_hashes) {
+  u64 start = osTimeMicrosecondsNow();
+  for (u32 i = 0; i < BENCH_DIFF_ROUNDS; i++) {
+    frameDiff(diff, old, next, sd, old_hashes, next_hashes);
+  }
+  return benchSecondsSince(start) / BENCH_DIFF_ROUNDS;
+}
+
+fn void benchFrameDiff(void) {
+  Arena arena = {0};
+  arenaInit(&arena);
+  Dim2 sd = { .width = BENCH_DIFF_WIDTH, .height = BENCH_DIFF_HEIGHT };
+  u32 cells = sd.width * sd.height;
+  Pixel* old = arenaAllocArray(&arena, Pixel, cells);
+  Pixel* next = arenaAllocArray(&arena, Pixel, cells);
+  u64* old_hashes = arenaAllocArray(&arena, u64, sd.height);
+  u64* next_hashes = arenaAllocArray(&arena, u64, sd.height);
+  FrameDiff reference = frameDiffCreate(&arena, cells);
+  reference.diff_row = frameDiffRowScalar;
+
+  DiffKernel kernels[3] = {
+    { "scalar", frameDiffRowScalar },
+  };
+  u32 kernel_count = 1;
+#if ARCH_X64
+  kernels[kernel_count++] = (DiffKernel){ "sse2", frameDiffRowSse2 };
+#endif
+#if ARCH_X64 && (COMPILER_GCC || COMPILER_CLANG)
+  if (__builtin_cpu_supports("avx2")) {
+    kernels[kernel_count++] = (DiffKernel){ "avx2", frameDiffRowAvx2 };
+  }
+#endif
+
+  printf("frame_diff: %u rows x %u cols (%u cells)\n", sd.height, sd.width, cells);
+  str cases[4] = { "identical", "one row", "1% changed", "all changed" };
+  for (u32 c = 0; c < 4; c++) {
+    fillAnsiFrame(old, cells, 1);
+    MemoryCopy(next, old, cells * sizeof(Pixel));
+    if (c == 1) {
+      // typing on one line
+      for (u32 x = 10; x < 60; x++) next[sd.height / 2 * sd.width + x].bytes[0] += 1;
+    } else if (c == 2) {
+      // scattered single cells and a few short runs, roughly what a cursor move and an edit touch
+      for (u32 i = 0; i < cells / 100; i++) {
+        next[(i*7919) % cells].background += 1;
+      }
+    } else if (c == 3) {
+      for (u32 i = 0; i < cells; i++) next[i].foreground += 1;
+    }
+    frameDiff(&reference, old, next, sd, NULL, NULL);
+
+    u64 start = osTimeMicrosecondsNow();
+    u32 sink = 0;
+    for (u32 i = 0; i < BENCH_DIFF_ROUNDS; i++) {
+      sink += threePassScan(old, next, cells);
+    }
+    f64 three_pass = benchSecondsSince(start) / BENCH_DIFF_ROUNDS;
+    printf("  %-11s %u changed cells in %u spans\n", cases[c], frameDiffCells(&reference), reference.length);
+    printf("    three isPixelEq passes  %8.1f us, found %u\n", three_pass * 1e6, sink / BENCH_DIFF_ROUNDS);
+
+    for (u32 k = 0; k < kernel_count; k++) {
+      FrameDiff diff = frameDiffCreate(&arena, cells);
+      diff.diff_row = kernels[k].diff_row;
+      f64 seconds = timeFrameDiff(&diff, old, next, sd, NULL, NULL);
+      assert(diff.length == reference.length && "the kernels disagree on the spans");
+      assert(memcmp(diff.spans, reference.spans, diff.length * sizeof(PixelSpan)) == 0 && "the kernels disagree on the spans");
+      printf("    %-22s  %8.1f us, %.1f GB/s per frame\n", kernels[k].name, seconds * 1e6,
+        2.0 * cells * sizeof(Pixel) / seconds / 1e9);
+    }
+
+    // what printfBufferAndSwap does: hash each row of the new frame, diff only the rows that moved
+    FrameDiff diff = frameDiffCreate(&arena, cells);
+    frameHashRows(old_hashes, old, sd);
+    f64 seconds = timeFrameDiff(&diff, old, next, sd, old_hashes, next_hashes);
+    assert(diff.length == reference.length && "row hashes skipped a changed row");
+    assert(memcmp(diff.spans, reference.spans, diff.length * sizeof(PixelSpan)) == 0 && "row hashes skipped a changed row");
+    printf("    %-22s  %8.1f us\n", "row hashes + default", seconds * 1e6);
+  }
+  arenaFree(&arena);
+}
+
+// an editor frame: a few dozen rows of text at the top of the screen, the rest blank.
+// typing changes one cell per frame, idle frames draw exactly the same thing again
+fn void drawMemoryFrame(TuiState* tui, u32 frame, bool typing) {
+  u32 width = tui->screen_dimensions.width;
+  fillAnsiFrame(tui->frame_buffer, BENCH_MEMORY_CONTENT_ROWS * width, 1);
+  if (typing) {
+    Pixel* cell = &tui->frame_buffer[3*width + frame % width];
+    cell->bytes[0] = 'A' + frame % 26;
+  }
+}
+
+// runs the editor's per frame steps, clearing the whole buffer like the loop used to or just
+// what tuiClearFrame finds. `total` gets the summed stats
+fn f64 timeMemoryFrames(TuiState* tui, bool clear_whole_buffer, bool typing, TuiFrameStats* total) {
+  MemoryZeroStruct(total, TuiFrameStats);
+  u64 start = osTimeMicrosecondsNow();
+  for (u32 f = 0; f < BENCH_MEMORY_FRAMES; f++) {
+    tui->prev_screen_dimensions = tui->screen_dimensions;
+    if (clear_whole_buffer) {
+      MemoryZero(tui->frame_buffer, tui->buffer_len * sizeof(Pixel));
+      tui->stats.cleared_bytes = tui->buffer_len * sizeof(Pixel);
+    } else {
+      tuiClearFrame(tui);
+    }
+    drawMemoryFrame(tui, f, typing);
+    printfBufferAndSwap(tui);
+    total->cleared_bytes += tui->stats.cleared_bytes;
+    total->hashed_bytes += tui->stats.hashed_bytes;
+    total->diffed_bytes += tui->stats.diffed_bytes;
+    total->encoded_bytes += tui->stats.encoded_bytes;
+  }
+  return benchSecondsSince(start) / BENCH_MEMORY_FRAMES;
+}
+
+fn void benchFrameMemory(void) {
+  Arena arena = {0};
+  arenaInit(&arena);
+  TuiState tui = tuiInit(&arena, BENCH_MEMORY_BUFFER_WIDTH * BENCH_MEMORY_BUFFER_HEIGHT);
+  tui.ansi.flush = benchAnsiFlush;
+  tui.screen_dimensions = (Dim2){ .width = BENCH_VIEW_SCREEN_WIDTH, .height = BENCH_VIEW_SCREEN_HEIGHT };
+
+  printf("frame_memory: %ux%u screen, %ux%u buffer, %u rows of text\n",
+    BENCH_VIEW_SCREEN_WIDTH, BENCH_VIEW_SCREEN_HEIGHT, BENCH_MEMORY_BUFFER_WIDTH, BENCH_MEMORY_BUFFER_HEIGHT,
+    BENCH_MEMORY_CONTENT_ROWS);
+  str modes[2] = { "idle", "typing" };
+  for (u32 m = 0; m < 2; m++) {
+    for (u32 run = 0; run < 2; run++) {
+      bool whole = run == 0;
+      TuiFrameStats total;
+      tui.redraw = true; // both runs start from the same full redraw
+      f64 seconds = timeMemoryFrames(&tui, whole, m == 1, &total);
+      u64 touched = (total.cleared_bytes + total.hashed_bytes + total.diffed_bytes) / BENCH_MEMORY_FRAMES;
+      printf("  %-6s %-12s %6.1f us/frame, %7llu bytes/frame touched: cleared %llu, hashed %llu, diffed %llu, %llu bytes of output\n",
+        modes[m], whole ? "clear all" : "dirty rows", seconds * 1e6, touched,
+        total.cleared_bytes / BENCH_MEMORY_FRAMES, total.hashed_bytes / BENCH_MEMORY_FRAMES,
+        total.diffed_bytes / BENCH_MEMORY_FRAMES, total.encoded_bytes / BENCH_MEMORY_FRAMES);
+    }
+  }
+  arenaFree(&arena);
+}
+
+// keeps what printfBufferAndSwap wrote for the last frame, to play it back
+global u8* bench_scroll_bytes = NULL;
+global u64 bench_scroll_length = 0;
+fn void benchScrollFlush(u8* bytes, u64 length) {
+  MemoryCopy(bench_scroll_bytes + bench_scroll_length, bytes, length);
+  bench_scroll_length += length;
+}
+
+// line `id` of a source file, indented and colored like the editor draws it
+fn void drawScrollLine(Pixel* row, u32 width, u32 id) {
+  u8 text[64] = {0};
+  u32 indent = 2 * (id % 4);
+  u32 length = snprintf((char*)text, sizeof(text), "%s value_%u = call_%u(%u);", id % 3 ? "int" : "u64", id, id % 17, id * 7);
+  for (u32 i = 0; i < length && indent + i < width; i++) {
+    Pixel* pixel = &row[indent + i];
+    pixel->bytes[0] = text[i];
+    pixel->foreground = i < 3 ? ANSI_MP_BLUE : i > length - 6 ? ANSI_LIGHT_GREEN : 0;
+  }
+}
+
+// a long file on screen, and every frame a line is inserted or deleted somewhere in view,
+// which moves every row below it. encoded once with just the diff and once by
+// printfBufferAndSwap, which can scroll the moved rows instead
+fn void benchScrollRegion(void) {
+  Arena arena = {0};
+  arenaInit(&arena);
+  Dim2 sd = { .width = BENCH_VIEW_SCREEN_WIDTH, .height = BENCH_VIEW_SCREEN_HEIGHT };
+  u32 cells = sd.width * sd.height;
+  TuiState tui = tuiInit(&arena, cells);
+  tui.ansi.flush = benchScrollFlush;
+  tui.screen_dimensions = sd;
+  tui.prev_screen_dimensions = sd;
+  bench_scroll_bytes = arenaAlloc(&arena, MB(4));
+  Pixel* replayed = arenaAllocArray(&arena, Pixel, cells);
+  Pixel* previous = arenaAllocArray(&arena, Pixel, cells);
+  AnsiEncoder plain = ansiEncoderCreate(&arena, MB(1), benchAnsiFlush);
+  FrameDiff diff = frameDiffCreate(&arena, cells);
+
+  u32* lines = arenaAllocArray(&arena, u32, BENCH_SCROLL_LINES + BENCH_SCROLL_FRAMES);
+  u32 line_count = BENCH_SCROLL_LINES;
+  for (u32 i = 0; i < line_count; i++) lines[i] = i;
+  u32 next_id = line_count;
+
+  u64 scroll_bytes = 0;
+  u64 plain_bytes = 0;
+  u64 scroll_us = 0;
+  u64 plain_us = 0;
+  tui.redraw = true;
+  for (u32 f = 0; f <= BENCH_SCROLL_FRAMES; f++) {
+    // edit a line in the top two thirds of the screen, a status line stays put at the bottom
+    u32 at = 100 + (f * 7919) % (sd.height * 2 / 3);
+    if (f > 0 && f % 2 == 1) {
+      memmove(lines + at + 1, lines + at, (line_count - at) * sizeof(u32));
+      lines[at] = next_id++;
+      line_count += 1;
+    } else if (f > 0) {
+      memmove(lines + at, lines + at + 1, (line_count - at - 1) * sizeof(u32));
+      line_count -= 1;
+    }
+    tuiClearFrame(&tui);
+    for (u16 y = 0; y + 1 < sd.height; y++) {
+      drawScrollLine(tui.frame_buffer + y * sd.width, sd.width, lines[100 + y]);
+    }
+    renderStrToBuffer(tui.frame_buffer, 0, sd.height - 1, "-- NORMAL --", sd);
+    tui.prev_cursor = tui.cursor;
+    tui.cursor = (Pos2){ .x = 2, .y = at - 100 };
+
+    // just the diff, against the frame the terminal shows now
+    u64 start = osTimeMicrosecondsNow();
+    u64 plain_before = plain.flushed;
+    if (f > 0) {
+      frameDiff(&diff, previous, tui.frame_buffer, sd, NULL, NULL);
+      ansiEncodeFrame(&plain, previous, tui.frame_buffer, sd, &diff, tui.cursor);
+      ansiFlush(&plain);
+    }
+    plain_us += osTimeMicrosecondsNow() - start;
+    MemoryCopy(previous, tui.frame_buffer, cells * sizeof(Pixel));
+
+    bench_scroll_length = 0;
+    start = osTimeMicrosecondsNow();
+    printfBufferAndSwap(&tui);
+    if (f == 0) {
+      replayAnsi(replayed, sd, bench_scroll_bytes, bench_scroll_length);
+      continue; // the first full redraw isn't part of it
+    }
+    scroll_us += osTimeMicrosecondsNow() - start;
+    scroll_bytes += bench_scroll_length;
+    plain_bytes += plain.flushed - plain_before;
+    replayAnsi(replayed, sd, bench_scroll_bytes, bench_scroll_length);
+    assert(screensLookAlike(replayed, previous, cells) && "scrolling didn't reproduce the frame");
+  }
+
+  printf("scroll_region: %ux%u screen, %u frames that each insert or delete a line\n", sd.width, sd.height, BENCH_SCROLL_FRAMES);
+  printf("  diff only        %6.1f us/frame, %6llu bytes/frame\n", (f64)plain_us / BENCH_SCROLL_FRAMES, plain_bytes / BENCH_SCROLL_FRAMES);
+  printf("  scroll regions   %6.1f us/frame, %6llu bytes/frame\n", (f64)scroll_us / BENCH_SCROLL_FRAMES, scroll_bytes / BENCH_SCROLL_FRAMES);
+  arenaFree(&arena);
+}
+
+// printfBufferAndSwap on the biggest screen the editor allows, with its diff and encode split
+// over 1 to 8 lanes. every lane count has to put the same frames on the screen
+fn f64 timeBandFrames(TuiState* tui, Pixel* replayed, bool whole, u32 seed) {
+  Dim2 sd = tui->screen_dimensions;
+  u32 cells = sd.width * sd.height;
+  u32 changed = cells * BENCH_ANSI_PARTIAL_PERCENT / 100;
+  u64 total_us = 0;
+  for (u32 f = 0; f < BENCH_BAND_FRAMES; f++) {
+    // the frame buffer last held the frame before the one on screen, a partial frame
+    // changes a few percent of what's on screen
+    if (whole) {
+      fillAnsiFrame(tui->frame_buffer, cells, seed + f);
+    } else {
+      MemoryCopy(tui->frame_buffer, tui->back_buffer, cells * sizeof(Pixel));
+      for (u32 i = 0; i < changed; i++) {
+        Pixel* cell = &tui->frame_buffer[(i*7919 + f*104729) % cells];
+        cell->bytes[0] = 'A' + (seed + f) % 26;
+        cell->foreground = f % 16;
+      }
+    }
+    tui->redraw = whole;
+    tui->prev_cursor = tui->cursor;
+    tui->cursor = (Pos2){ .x = f % sd.width, .y = f % sd.height };
+    bench_scroll_length = 0;
+    u64 start = osTimeMicrosecondsNow();
+    printfBufferAndSwap(tui);
+    total_us += osTimeMicrosecondsNow() - start;
+    if (f % 16 == 0) {
+      replayAnsi(replayed, sd, bench_scroll_bytes, bench_scroll_length);
+      assert(screensLookAlike(replayed, tui->back_buffer, cells) && "the bands didn't reproduce the frame");
+    } else {
+      MemoryCopy(replayed, tui->back_buffer, cells * sizeof(Pixel));
+    }
+  }
+  return (f64)total_us / BENCH_BAND_FRAMES;
+}
+
+fn void benchBandEncode(void) {
+  Arena arena = {0};
+  arenaInit(&arena);
+  Dim2 sd = { .width = BENCH_DIFF_WIDTH, .height = BENCH_DIFF_HEIGHT };
+  u32 cells = sd.width * sd.height;
+  bench_scroll_bytes = arenaAlloc(&arena, MB(32));
+  Pixel* replayed = arenaAllocArray(&arena, Pixel, cells);
+  u32 lane_counts[4] = { 1, 2, 4, 8 };
+  f64 base_full = 0;
+  f64 base_partial = 0;
+
+  printf("band_encode: %ux%u screen, %u frames each\n", sd.width, sd.height, BENCH_BAND_FRAMES);
+  for (u32 l = 0; l < arrayLen(lane_counts); l++) {
+    TuiState tui = tuiInit(&arena, cells);
+    tui.ansi.flush = benchScrollFlush;
+    tui.screen_dimensions = sd;
+    tui.prev_screen_dimensions = sd;
+    TuiLanes lanes = {0};
+    if (lane_counts[l] > 1) {
+      tuiLanesStart(&lanes, &arena, lane_counts[l], cells, sd.width);
+      tui.lanes = &lanes;
+    }
+    MemoryZero(replayed, cells * sizeof(Pixel));
+    f64 full_us = timeBandFrames(&tui, replayed, true, 1);
+    f64 partial_us = timeBandFrames(&tui, replayed, false, 2);
+    if (tui.lanes != NULL) {
+      tuiLanesStop(&lanes);
+    }
+    if (l == 0) {
+      base_full = full_us;
+      base_partial = partial_us;
+    }
+    printf("  %u lane%s  full redraw %8.1f us/frame (%.2fx), partial (%u%% changed) %7.1f us/frame (%.2fx)\n",
+      lane_counts[l], lane_counts[l] == 1 ? " " : "s", full_us, base_full / full_us,
+      BENCH_ANSI_PARTIAL_PERCENT, partial_us, base_partial / partial_us);
+  }
+  arenaFree(&arena);
+}
+
+#if OS_LINUX
+// what infiniteUILoop runs in the child: a few rows of text and a line that changes with every key
+fn bool benchLoopUpdate(TuiState* tui, void* state, u8* input_buffer, u64 loop_count) {
+  (void)loop_count;
+  u32* keys = (u32*)state;
+  if (input_buffer[0] != 0) *keys += 1;
+  u8 line[32] = {0};
+  snprintf((char*)line, sizeof(line), "keys: %u", *keys);
+  renderStrToBuffer(tui->frame_buffer, 0, 0, (str)line, tui->screen_dimensions);
+  for (u16 y = 2; y < 20 && y < tui->screen_dimensions.height; y++) {
+    renderStrToBuffer(tui->frame_buffer, 2, y, "int main() { return 0; }", tui->screen_dimensions);
+  }
+  return input_buffer[0] == 'q';
+}
+
+// user + system time the process has used, in clock ticks
+fn u64 benchProcessTicks(i32 pid) {
+  u8 path[64] = {0};
+  snprintf((char*)path, sizeof(path), "/proc/%d/stat", pid);
+  FILE* file = fopen((char*)path, "r");
+  unsigned long user = 0, system = 0;
+  if (file != NULL) {
+    fscanf(file, "%*d (%*[^)]) %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu", &user, &system);
+    fclose(file);
+  }
+  return user + system;
+}
+
+// reads whatever the child writes until it has been quiet for `quiet_us`. returns the bytes read,
+// keeping the start of it in `out` when given
+fn u64 benchDrainPty(i32 master, u64 quiet_us, u8* out, u64 out_size) {
+  u64 total = 0;
+  u8 bytes[4096];
+  struct pollfd fd = { .fd = master, .events = POLLIN };
+  while (poll(&fd, 1, quiet_us / 1000) > 0) {
+    i64 length = read(master, bytes, sizeof(bytes));
+    if (length <= 0) break;
+    if (out != NULL && total < out_size) MemoryCopy(out + total, bytes, Min((u64)length, out_size - total));
+    total += length;
+  }
+  return total;
+}
+
+// time from `write` to the first byte of the frame it causes
+fn u64 benchFirstOutputUs(i32 master, u64 start) {
+  struct pollfd fd = { .fd = master, .events = POLLIN };
+  poll(&fd, 1, 1000);
+  return osTimeMicrosecondsNow() - start;
+}
+
+fn int benchCompareU64(const void* a, const void* b) {
+  u64 x = *(u64*)a, y = *(u64*)b;
+  return x < y ? -1 : x > y;
+}
+
+// starts infiniteUILoop in a child on a pseudo terminal of `size`, returns its pid
+fn i32 benchForkLoop(i32* master, struct winsize size, bool polling, bool pipelined, bool (*update)(TuiState*, void*, u8*, u64)) {
+  i32 slave;
+  openpty(master, &slave, NULL, NULL, &size);
+  fflush(stdout);
+  i32 pid = fork();
+  if (pid == 0) {
+    close(*master);
+    setsid();
+    ioctl(slave, TIOCSCTTY, 0); // so resizing the pty sends us SIGWINCH
+    dup2(slave, STDIN_FILENO);
+    dup2(slave, STDOUT_FILENO);
+    close(slave);
+    TUI_FORCE_POLLING = polling;
+    TUI_PIPELINED = pipelined;
+    u32 keys = 0;
+    infiniteUILoop(BENCH_VIEW_SCREEN_WIDTH, BENCH_VIEW_SCREEN_HEIGHT, 1000000/60, &keys, update);
+    _exit(0);
+  }
+  close(slave);
+  return pid;
+}
+
+// runs infiniteUILoop in a child on a pseudo terminal and plays the user from here
+fn void benchLoopSession(bool polling, bool pipelined) {
+  i32 master;
+  struct winsize size = { .ws_row = 30, .ws_col = 100 };
+  i32 pid = benchForkLoop(&master, size, polling, pipelined, benchLoopUpdate);
+  benchDrainPty(master, 300000, NULL, 0); // the first frame
+
+  // idle: nobody types for a while
+  u64 ticks_before = benchProcessTicks(pid);
+  osSleepMicroseconds(BENCH_LOOP_IDLE_US);
+  f64 idle_cpu = (f64)(benchProcessTicks(pid) - ticks_before) / sysconf(_SC_CLK_TCK) / (BENCH_LOOP_IDLE_US / 1e6);
+
+  // keystrokes at uneven intervals, so they land all over the polling loop's frame period
+  u64 latencies[BENCH_LOOP_KEYS];
+  for (u32 i = 0; i < BENCH_LOOP_KEYS; i++) {
+    u64 start = osTimeMicrosecondsNow();
+    write(master, "a", 1);
+    latencies[i] = benchFirstOutputUs(master, start);
+    benchDrainPty(master, 2000, NULL, 0);
+    osSleepMicroseconds(1000 + (i * 7919) % 17000);
+  }
+  qsort(latencies, BENCH_LOOP_KEYS, sizeof(u64), benchCompareU64);
+  u64 sum = 0;
+  for (u32 i = 0; i < BENCH_LOOP_KEYS; i++) sum += latencies[i];
+
+  // resize: the next frame should redraw the whole screen
+  size.ws_col = 80;
+  size.ws_row = 24;
+  u64 start = osTimeMicrosecondsNow();
+  ioctl(master, TIOCSWINSZ, &size);
+  u8 frame[256] = {0};
+  u64 resize_us = 0;
+  while (osTimeMicrosecondsNow() - start < 2000000) {
+    if (benchDrainPty(master, 1000, frame, sizeof(frame)) > 0 && strstr((char*)frame, "\033[2J") != NULL) {
+      resize_us = osTimeMicrosecondsNow() - start;
+      break;
+    }
+  }
+  assert(resize_us != 0 && "the loop never noticed the resize");
+
+  write(master, "q", 1);
+  benchDrainPty(master, 50000, NULL, 0);
+  waitpid(pid, NULL, 0);
+  close(master);
+
+  printf("  %-9s idle cpu %5.2f%%, keystroke to first byte: mean %6.0f us, p50 %6llu us, p99 %6llu us, max %6llu us; resize %6llu us\n",
+    polling ? "polling" : pipelined ? "pipelined" : "events", idle_cpu * 100, (f64)sum / BENCH_LOOP_KEYS,
+    latencies[BENCH_LOOP_KEYS / 2], latencies[BENCH_LOOP_KEYS * 99 / 100], latencies[BENCH_LOOP_KEYS - 1], resize_us);
+}
+#endif
+
+// every key repaints the whole screen, and the last one puts "done" in the corner
+fn bool benchSlowUpdate(TuiState* tui, void* state, u8* input_buffer, u64 loop_count) {
+  (void)loop_count;
+  u32* keys = (u32*)state;
+  for (u32 i = 0; i < 4; i++) {
+    if (input_buffer[i] == 'a') *keys += 1;
+  }
+  Dim2 sd = tui->screen_dimensions;
+  for (u16 y = 0; y < sd.height; y++) {
+    for (u16 x = 0; x < sd.width; x++) {
+      Pixel* pixel = &tui->frame_buffer[y * sd.width + x];
+      pixel->bytes[0] = 'a' + (*keys + x + y) % 26;
+      pixel->foreground = 1 + *keys % 8;
+    }
+  }
+  if (*keys == BENCH_SLOW_KEYS) {
+    renderStrToBuffer(tui->frame_buffer, 0, 0, "DONE", sd);
+  }
+  return input_buffer[0] == 'q';
+}
+
+// reads at most `budget` bytes of what's waiting, returns whether "DONE" was in them
+fn bool benchSlowRead(i32 master, u64 budget, u8* carry, u64* total) {
+  u8 bytes[BENCH_SLOW_BYTES_PER_MS + 4];
+  MemoryCopy(bytes, carry, 3); // the end of the last read, in case the word is split
+  struct pollfd fd = { .fd = master, .events = POLLIN };
+  if (poll(&fd, 1, 0) <= 0) return false;
+  i64 length = read(master, bytes + 3, Min(budget, (u64)BENCH_SLOW_BYTES_PER_MS));
+  if (length <= 0) return false;
+  *total += length;
+  bytes[3 + length] = 0;
+  MemoryCopy(carry, bytes + length, 3);
+  for (i64 i = 0; i < length; i++) {
+    if (bytes[i] == 'D' && bytes[i+1] == 'O' && bytes[i+2] == 'N' && bytes[i+3] == 'E') return true;
+  }
+  return false;
+}
+
+#if OS_LINUX
+// a terminal that can't keep up: keys come every ms, but it only takes BENCH_SLOW_BYTES_PER_MS.
+// measures how long after the last key the screen shows it
+fn void benchSlowSession(bool pipelined) {
+  i32 master;
+  struct winsize size = { .ws_row = 30, .ws_col = 100 };
+  i32 pid = benchForkLoop(&master, size, false, pipelined, benchSlowUpdate);
+  benchDrainPty(master, 300000, NULL, 0); // the first frame
+
+  u8 carry[3] = {0};
+  u64 total = 0;
+  bool done = false;
+  u64 start = osTimeMicrosecondsNow();
+  for (u32 i = 0; i < BENCH_SLOW_KEYS; i++) {
+    write(master, "a", 1);
+    done = benchSlowRead(master, BENCH_SLOW_BYTES_PER_MS, carry, &total) || done;
+    osSleepMicroseconds(1000);
+  }
+  u64 last_key = osTimeMicrosecondsNow();
+  while (!done && osTimeMicrosecondsNow() - last_key < 20000000) {
+    done = benchSlowRead(master, BENCH_SLOW_BYTES_PER_MS, carry, &total);
+    osSleepMicroseconds(1000);
+  }
+  u64 shown = osTimeMicrosecondsNow();
+  assert(done && "the last key never made it to the screen");
+
+  write(master, "q", 1);
+  benchDrainPty(master, 50000, NULL, 0);
+  waitpid(pid, NULL, 0);
+  close(master);
+  printf("  %-9s last key on screen %6.1f ms after it was typed, %.1f ms in all, %llu KB written\n",
+    pipelined ? "pipelined" : "events", (shown - last_key) / 1000.0, (shown - start) / 1000.0, total / 1024);
+}
+#endif
+
+fn void benchSlowTerminal(void) {
+#if OS_LINUX
+  printf("slow_terminal: %u keys, 1 per ms, into a terminal reading %u bytes/ms of full-screen frames\n",
+    BENCH_SLOW_KEYS, BENCH_SLOW_BYTES_PER_MS);
+  benchSlowSession(false);
+  benchSlowSession(true);
+#else
+  printf("slow_terminal: needs linux\n");
+#endif
+}
+
+fn void benchInputLoop(void) {
+#if OS_LINUX
+  printf("input_loop: infiniteUILoop on a pty, %u keystrokes, %.1f s idle\n", BENCH_LOOP_KEYS, BENCH_LOOP_IDLE_US / 1e6);
+  benchLoopSession(true, false);
+  benchLoopSession(false, false);
+  benchLoopSession(false, true);
+#else
+  printf("input_loop: needs linux\n");
+#endif
+}
+
+global Benchmark BENCHMARKS[] = {
+  { "tree_build", benchTreeBuild },
+  { "tree_memory", benchTreeMemory },
+  { "tree_walk", benchTreeWalk },
+  { "render_traversal", benchRenderTraversal },
+  { "tree_insert", benchTreeInsert },
+  { "tree_lookup", benchTreeLookup },
+  { "tree_compact", benchTreeCompact },
+  { "tree_preorder", benchTreePreorder },
+  { "tree_snapshot", benchTreeSnapshot },
+  { "journal_undo", benchJournalUndo },
+  { "subtree_paste", benchSubtreePaste },
+  { "view_cache", benchViewCache },
+  { "tree_layout", benchTreeLayout },
+  { "viewport_render", benchViewportRender },
+  { "ansi_encode", benchAnsiEncode },
+  { "frame_diff", benchFrameDiff },
+  { "frame_memory", benchFrameMemory },
+  { "scroll_region", benchScrollRegion },
+  { "band_encode", benchBandEncode },
+  { "input_loop", benchInputLoop },
+  { "slow_terminal", benchSlowTerminal },
+};
+
+i32 main(i32 argc, ptr argv[]) {
+  osInit();
+  ThreadContext tctx = {0};
+  tctxInit(&tctx);
+
+  // run every benchmark, or just the ones named on the command line
+  for (u32 i = 0; i < arrayLen(BENCHMARKS); i++) {
+    bool selected = argc < 2;
+    for (i32 j = 1; j < argc; j++) {
+      if (strcmp(argv[j], BENCHMARKS[i].name) == 0) {
+        selected = true;
+      }
+    }
+    if (selected) {
+      BENCHMARKS[i].run();
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,747 @@
+#include "c_tree.h"
+
+fn NodeHandle nodeHandleMake(u32 index, u32 generation) {
+  assert(index <= NODE_HANDLE_INDEX_MASK);
+  return ((generation & NODE_HANDLE_GENERATION_MASK) << NODE_HANDLE_INDEX_BITS) | index;
+}
+
+fn u32 nodeHandleIndex(NodeHandle handle) {
+  return handle & NODE_HANDLE_INDEX_MASK;
+}
+
+fn u32 nodeHandleGeneration(NodeHandle handle) {
+  return handle >> NODE_HANDLE_INDEX_BITS;
+}
+
+fn void payloadTableInit(NodePayloadTable* table, u32 item_size) {
+  table->item_size = item_size;
+  table->capacity = NODE_POOL_INITIAL_CAPACITY;
+  table->length = 1; // item 0 is the nil payload
+  table->first_free = NODE_PAYLOAD_NIL;
+  arenaInitSized(&table->arena, (u64)NODE_POOL_MAX_NODES * item_size);
+  table->items = arenaAlloc(&table->arena, (u64)table->capacity * item_size);
+  MemoryZero(table->items, item_size);
+}
+
+fn void* payloadFromIndex(NodePayloadTable* table, u32 index) {
+  assert(index < table->length);
+  return table->items + ((u64)index * table->item_size);
+}
+
+fn u32 payloadAlloc(NodePayloadTable* table) {
+  u32 index = table->first_free;
+  if (index != NODE_PAYLOAD_NIL) {
+    table->first_free = *(u32*)payloadFromIndex(table, index);
+  } else {
+    if (table->capacity == table->length) {
+      assert(table->capacity < NODE_POOL_MAX_NODES && "NodePayloadTable is full");
+      arenaAlloc(&table->arena, (u64)table->capacity * table->item_size); // extends `items` in place
+      table->capacity *= 2;
+    }
+    index = table->length++;
+  }
+  MemoryZero(payloadFromIndex(table, index), table->item_size);
+  return index;
+}
+
+fn void payloadRelease(NodePayloadTable* table, u32 index) {
+  if (index == NODE_PAYLOAD_NIL) return;
+  *(u32*)payloadFromIndex(table, index) = table->first_free;
+  table->first_free = index;
+}
+
+fn NodePayloadTable* payloadTableForType(CTree* tree, NodeType type) {
+  switch (type) {
+    case NodeTypeFunction:
+      return &tree->functions;
+    case NodeTypeNumericLiteral:
+      return &tree->numeric_literals;
+    default:
+      return NULL;
+  }
+}
+
+// gives the node in slot `index` the next id and makes that id resolve to it
+fn void assignNodeId(CTree* tree, u32 index) {
+  CNode* node = &tree->nodes[index];
+  node->id = tree->next_id++;
+  if (node->id == tree->id_capacity) {
+    assert(tree->id_capacity < MAX_u32 / 2 && "CTree ran out of node ids");
+    if ((u64)tree->id_capacity * 2 * sizeof(NodeHandle) <= tree->id_arena.max) {
+      arenaAllocArray(&tree->id_arena, NodeHandle, tree->id_capacity); // extends `handle_by_id` in place
+    } else {
+      // ids outlive the nodes they named, so a long session can outgrow the reservation
+      Arena larger = {0};
+      arenaInitSized(&larger, tree->id_arena.max * 2);
+      NodeHandle* moved = arenaAllocArray(&larger, NodeHandle, (u64)tree->id_capacity * 2);
+      MemoryCopy(moved, tree->handle_by_id, (u64)tree->id_capacity * sizeof(NodeHandle));
+      arenaFree(&tree->id_arena);
+      tree->id_arena = larger;
+      tree->handle_by_id = moved;
+    }
+    tree->id_capacity *= 2;
+  }
+  tree->handle_by_id[node->id] = nodeHandleMake(index, node->generation);
+}
+
+// `count` fresh slots at the end of the pool, never from the free list, so a bulk copy
+// lands contiguous. the slots keep their generations, everything else is the caller's.
+fn u32 allocNodeRange(CTree* tree, u32 count) {
+  assert(tree->length + (u64)count <= NODE_POOL_MAX_NODES && "CTree node pool is full");
+  while (tree->length + count > tree->capacity) {
+    arenaAllocArray(&tree->arena, CNode, tree->capacity); // extends `tree->nodes` in place
+    tree->capacity *= 2;
+  }
+  u32 result = tree->length;
+  tree->length += count;
+  return result;
+}
+
+fn NodeHandle allocNode(CTree* tree, NodeType type) {
+  u32 index = tree->first_free;
+  if (index != NODE_NIL) {
+    tree->first_free = tree->nodes[index].next_sibling;
+    tree->free_count -= 1;
+  } else {
+    if (tree->capacity == tree->length) {
+      assert(tree->capacity < NODE_POOL_MAX_NODES && "CTree node pool is full");
+      // the tree's arena holds nothing but nodes, so this extends `tree->nodes` in place
+      arenaAllocArray(&tree->arena, CNode, tree->capacity);
+      tree->capacity *= 2;
+    }
+    index = tree->length++;
+  }
+  CNode* node = &tree->nodes[index];
+  u32 generation = node->generation;
+  MemoryZeroStruct(node, CNode);
+  node->generation = generation;
+  node->type = type;
+  node->flags = NODE_FLAG_LAYOUT_DIRTY; // never been laid out
+  assignNodeId(tree, index);
+  NodePayloadTable* table = payloadTableForType(tree, type);
+  if (table != NULL) {
+    node->payload = payloadAlloc(table);
+  }
+  return nodeHandleMake(index, generation);
+}
+
+fn CTree cTreeCreate() {
+  CTree result = {
+    .capacity = NODE_POOL_INITIAL_CAPACITY,
+    .length = 1, // slot 0 is the nil node
+  };
+  arenaInitSized(&result.arena, (u64)NODE_POOL_MAX_NODES * sizeof(CNode));
+  result.nodes = arenaAllocArray(&result.arena, CNode, result.capacity);
+  MemoryZeroStruct(&result.nodes[0], CNode);
+  payloadTableInit(&result.functions, sizeof(CFnDetails));
+  payloadTableInit(&result.numeric_literals, sizeof(String));
+  result.id_capacity = NODE_POOL_INITIAL_CAPACITY;
+  arenaInitSized(&result.id_arena, (u64)NODE_POOL_MAX_NODES * sizeof(NodeHandle));
+  result.handle_by_id = arenaAllocArray(&result.id_arena, NodeHandle, result.id_capacity);
+  result.root = allocNode(&result, NodeTypeRoot);
+  result.nodes[nodeHandleIndex(result.root)].parent = result.root; // points back to self
+  return result;
+}
+
+fn void cTreeRelease(CTree* tree) {
+  arenaFree(&tree->arena);
+  arenaFree(&tree->functions.arena);
+  arenaFree(&tree->numeric_literals.arena);
+  arenaFree(&tree->id_arena);
+  MemoryZeroStruct(tree, CTree);
+}
+
+fn CNode* nodeFromHandle(CTree* tree, NodeHandle handle) {
+  // stale or out-of-range handles resolve to the nil node instead of someone else's slot.
+  // a retired slot is back at the generation its oldest handles have, but it's never reused
+  // and stays NodeTypeInvalid, so checking the type catches those.
+  // NOTE: never write through the result without checking it against `&tree->nodes[0]`
+  u32 index = nodeHandleIndex(handle);
+  CNode* result = &tree->nodes[NODE_NIL];
+  if (index < tree->length && (tree->nodes[index].generation & NODE_HANDLE_GENERATION_MASK) == nodeHandleGeneration(handle)
+      && tree->nodes[index].type != NodeTypeInvalid) {
+    result = &tree->nodes[index];
+  }
+  return result;
+}
+
+fn NodeHandle handleFromNode(CTree* tree, CNode* node) {
+  u32 index = (u32)(node - tree->nodes);
+  assert(index < tree->length);
+  if (index == NODE_NIL) return NODE_NIL;
+  return nodeHandleMake(index, node->generation);
+}
+
+fn bool isNodeHandleValid(CTree* tree, NodeHandle handle) {
+  return handle != NODE_NIL && nodeFromHandle(tree, handle) != &tree->nodes[NODE_NIL];
+}
+
+// splices the already-allocated `node` into `parent`'s children right after `prev`.
+// `prev` == NODE_NIL makes it the first child. every insert is O(1).
+fn void linkNodeAfter(CTree* tree, NodeHandle parent_handle, NodeHandle prev_handle, NodeHandle node_handle) {
+  CNode* parent = nodeFromHandle(tree, parent_handle);
+  CNode* node = nodeFromHandle(tree, node_handle);
+  assert(parent != &tree->nodes[NODE_NIL]);
+  assert(node != &tree->nodes[NODE_NIL]);
+  node->parent = parent_handle;
+  node->prev_sibling = prev_handle;
+  if (prev_handle == NODE_NIL) {
+    node->next_sibling = parent->first_child;
+    parent->first_child = node_handle;
+  } else {
+    CNode* prev = nodeFromHandle(tree, prev_handle);
+    assert(prev->parent == parent_handle);
+    node->next_sibling = prev->next_sibling;
+    prev->next_sibling = node_handle;
+  }
+  if (node->next_sibling == NODE_NIL) {
+    parent->last_child = node_handle;
+  } else {
+    nodeFromHandle(tree, node->next_sibling)->prev_sibling = node_handle;
+  }
+  parent->child_count += 1;
+  tree->edit_generation += 1;
+  tree->content_generation += 1;
+  // a relinked subtree may already be marked, but its new ancestors aren't
+  node->flags |= NODE_FLAG_LAYOUT_DIRTY;
+  markNodeDirty(tree, parent_handle);
+}
+
+fn NodeHandle addNode(CTree* tree, NodeType type, NodeHandle parent_handle) {
+  NodeHandle handle = allocNode(tree, type);
+  linkNodeAfter(tree, parent_handle, nodeFromHandle(tree, parent_handle)->last_child, handle);
+  return handle;
+}
+
+fn NodeHandle addNodeFirstChild(CTree* tree, NodeType type, NodeHandle parent_handle) {
+  NodeHandle handle = allocNode(tree, type);
+  linkNodeAfter(tree, parent_handle, NODE_NIL, handle);
+  return handle;
+}
+
+fn NodeHandle addNodeBeforeSibling(CTree* tree, NodeType type, NodeHandle parent_handle, NodeHandle sibling_handle) {
+  NodeHandle handle = allocNode(tree, type);
+  linkNodeAfter(tree, parent_handle, nodeFromHandle(tree, sibling_handle)->prev_sibling, handle);
+  return handle;
+}
+
+fn NodeHandle addNodeAfterSibling(CTree* tree, NodeType type, NodeHandle parent_handle, NodeHandle sibling_handle) {
+  NodeHandle handle = allocNode(tree, type);
+  linkNodeAfter(tree, parent_handle, sibling_handle, handle);
+  return handle;
+}
+
+// detaches `node` from its parent. it and its descendants stay live (and keep their ids)
+// until they're linked back in with linkNodeAfter or freed with deleteSubtree.
+fn void unlinkNode(CTree* tree, NodeHandle node_handle) {
+  CNode* node = nodeFromHandle(tree, node_handle);
+  assert(node != &tree->nodes[NODE_NIL]);
+  assert(node_handle != tree->root && "can't unlink the root");
+  CNode* parent = nodeFromHandle(tree, node->parent);
+  if (node->prev_sibling == NODE_NIL) {
+    parent->first_child = node->next_sibling;
+  } else {
+    nodeFromHandle(tree, node->prev_sibling)->next_sibling = node->next_sibling;
+  }
+  if (node->next_sibling == NODE_NIL) {
+    parent->last_child = node->prev_sibling;
+  } else {
+    nodeFromHandle(tree, node->next_sibling)->prev_sibling = node->prev_sibling;
+  }
+  parent->child_count -= 1;
+  markNodeDirty(tree, node->parent);
+  node->parent = NODE_NIL;
+  node->prev_sibling = NODE_NIL;
+  node->next_sibling = NODE_NIL;
+  tree->edit_generation += 1;
+  tree->content_generation += 1;
+}
+
+// gives back the string chunks a node's payload owns, leaving its lists empty
+fn void releaseNodeStrings(CTree* tree, CNode* node, StringArena* strings) {
+  if (node->type == NodeTypeFunction) {
+    CFnDetails* function = nodeFunction(tree, node);
+    releaseStringChunkList(strings, &function->name);
+    releaseStringChunkList(strings, &function->return_type);
+    for (u32 i = 0; i < function->arg_count && i < arrayLen(function->args); i++) {
+      releaseStringChunkList(strings, &function->args[i].type);
+      releaseStringChunkList(strings, &function->args[i].name);
+    }
+  }
+}
+
+fn void freeNodeSlot(CTree* tree, u32 index, StringArena* strings) {
+  CNode* node = &tree->nodes[index];
+  NodePayloadTable* table = payloadTableForType(tree, node->type);
+  if (table != NULL) {
+    if (strings != NULL) {
+      releaseNodeStrings(tree, node, strings);
+    }
+    payloadRelease(table, node->payload);
+  }
+  tree->handle_by_id[node->id] = NODE_NIL;
+  node->generation += 1; // every outstanding handle to this slot goes stale
+  node->type = NodeTypeInvalid;
+  node->payload = NODE_PAYLOAD_NIL;
+  tree->free_count += 1;
+  if (node->generation == 0) {
+    // the generation wrapped, so a handle from 256 frees ago would be valid again. the slot
+    // stays retired until cTreeCompact, which changes every handle anyway, packs it away
+    return;
+  }
+  node->next_sibling = tree->first_free;
+  tree->first_free = index;
+}
+
+// unlinks `node` and returns it and all of its descendants to the free list.
+// `strings` is where function names/types were allocated, NULL to leave them alone.
+fn void deleteSubtree(CTree* tree, NodeHandle node_handle, StringArena* strings) {
+  if (nodeFromHandle(tree, node_handle)->parent != NODE_NIL) { // detached subtrees are already unlinked
+    unlinkNode(tree, node_handle);
+  }
+
+  // free in postorder: the next node is always found before the current one is freed,
+  // and a parent is only freed after everything below it
+  NodeHandle handle = node_handle;
+  while (nodeFromHandle(tree, handle)->first_child != NODE_NIL) {
+    handle = nodeFromHandle(tree, handle)->first_child;
+  }
+  while (true) {
+    CNode* node = nodeFromHandle(tree, handle);
+    bool is_last = handle == node_handle;
+    NodeHandle next = node->parent;
+    if (!is_last && node->next_sibling != NODE_NIL) {
+      next = node->next_sibling;
+      while (nodeFromHandle(tree, next)->first_child != NODE_NIL) {
+        next = nodeFromHandle(tree, next)->first_child;
+      }
+    }
+    freeNodeSlot(tree, nodeHandleIndex(handle), strings);
+    if (is_last) break;
+    handle = next;
+  }
+}
+
+fn NodeHandle nextNodePreorder(CTree* tree, NodeHandle handle, NodeHandle subtree_root) {
+  CNode* node = nodeFromHandle(tree, handle);
+  if (node->first_child != NODE_NIL) {
+    return node->first_child;
+  }
+  while (handle != subtree_root) {
+    if (node->next_sibling != NODE_NIL) {
+      return node->next_sibling;
+    }
+    handle = node->parent;
+    node = nodeFromHandle(tree, handle);
+  }
+  return NODE_NIL;
+}
+
+fn CTreePreorder preorderCreate() {
+  CTreePreorder result = {
+    .edit_generation = MAX_u64, // never matches a tree, so the first sync always builds
+  };
+  arenaInitSized(&result.arena, (u64)NODE_POOL_MAX_NODES * (sizeof(NodeHandle) + 3*sizeof(u32)) * 2);
+  return result;
+}
+
+fn void preorderRelease(CTreePreorder* preorder) {
+  arenaFree(&preorder->arena);
+  MemoryZeroStruct(preorder, CTreePreorder);
+}
+
+// rebuilds `preorder` if `tree` changed shape since the last call, returns whether it did
+fn bool preorderSync(CTreePreorder* preorder, CTree* tree) {
+  if (preorder->edit_generation == tree->edit_generation) {
+    return false;
+  }
+  // an upper bound: live nodes include detached subtrees (held by undo history) the walk won't reach
+  u32 live = tree->length - 1 - tree->free_count;
+  if (live > preorder->capacity) {
+    arenaClear(&preorder->arena);
+    preorder->capacity = Max(live, preorder->capacity * 2);
+    preorder->nodes = arenaAllocArray(&preorder->arena, NodeHandle, preorder->capacity);
+    preorder->subtree_sizes = arenaAllocArray(&preorder->arena, u32, preorder->capacity);
+    preorder->depths = arenaAllocArray(&preorder->arena, u32, preorder->capacity);
+    preorder->open = arenaAllocArray(&preorder->arena, u32, preorder->capacity);
+  }
+
+  // a node's subtree ends right before the next node at the same depth or shallower,
+  // so each visit closes every open ancestor that deep
+  u32* open = preorder->open;
+  u32 open_count = 0;
+
+  u32 count = 0;
+  u32 depth = 0;
+  NodeHandle handle = tree->root;
+  while (handle != NODE_NIL) {
+    while (open_count > 0 && preorder->depths[open[open_count-1]] >= depth) {
+      u32 closed = open[--open_count];
+      preorder->subtree_sizes[closed] = count - closed;
+    }
+    preorder->nodes[count] = handle;
+    preorder->depths[count] = depth;
+    open[open_count++] = count;
+    count += 1;
+
+    CNode* node = nodeFromHandle(tree, handle);
+    if (node->first_child != NODE_NIL) {
+      handle = node->first_child;
+      depth += 1;
+      continue;
+    }
+    while (handle != tree->root && node->next_sibling == NODE_NIL) {
+      handle = node->parent;
+      node = nodeFromHandle(tree, handle);
+      depth -= 1;
+    }
+    handle = handle == tree->root ? NODE_NIL : node->next_sibling;
+  }
+  while (open_count > 0) {
+    u32 closed = open[--open_count];
+    preorder->subtree_sizes[closed] = count - closed;
+  }
+  // the rest are detached subtrees the journal keeps for undo
+  assert(count <= live && "CTree's free count is off");
+
+  preorder->length = count;
+  preorder->edit_generation = tree->edit_generation;
+  return true;
+}
+
+fn NodeHandle compactRemap(CTree* tree, u32* new_index_of, CNode* packed, NodeHandle handle) {
+  if (!isNodeHandleValid(tree, handle)) return NODE_NIL;
+  u32 index = new_index_of[nodeHandleIndex(handle)];
+  return nodeHandleMake(index, packed[index].generation);
+}
+
+// re-packs every live node into slots 1..live in preorder, so full-tree walks read
+// `nodes` front to back. detached subtrees are packed after the tree itself. every handle changes: the ones in `external` get rewritten,
+// anything else has to be re-resolved through handleFromId.
+fn void cTreeCompact(CTree* tree, NodeHandle** external, u32 external_count) {
+  u32 old_length = tree->length;
+  u32 live = old_length - 1 - tree->free_count;
+  Arena scratch = {0};
+  arenaInitSized(&scratch, (u64)old_length * sizeof(u32) + (u64)(live + 1) * sizeof(CNode) + MB(1));
+  u32* new_index_of = arenaAllocArray(&scratch, u32, old_length);
+  CNode* packed = arenaAllocArray(&scratch, CNode, live + 1);
+
+  u32 count = 1;
+  MemoryZero(new_index_of, (u64)old_length * sizeof(u32));
+  NodeHandle subtree_root = tree->root;
+  for (u32 scan = 1; subtree_root != NODE_NIL;) {
+    for (NodeHandle h = subtree_root; h != NODE_NIL; h = nextNodePreorder(tree, h, subtree_root)) {
+      u32 old_index = nodeHandleIndex(h);
+      new_index_of[old_index] = count;
+      packed[count] = tree->nodes[old_index];
+      // bump past whatever generation the slot had, so old handles into it go stale
+      packed[count].generation = tree->nodes[count].generation + 1;
+      packed[count].flags |= NODE_FLAG_LAYOUT_DIRTY; // layouts are kept by slot
+      count += 1;
+    }
+    // then any detached subtrees (unlinked but not deleted, e.g. held by undo history)
+    subtree_root = NODE_NIL;
+    for (; scan < old_length && subtree_root == NODE_NIL; scan++) {
+      CNode* node = &tree->nodes[scan];
+      if (node->type != NodeTypeInvalid && node->parent == NODE_NIL && new_index_of[scan] == 0) {
+        subtree_root = nodeHandleMake(scan, node->generation);
+      }
+    }
+  }
+  assert(count == live + 1 && "CTree has live nodes that aren't reachable from the root or a detached subtree");
+
+  // handles only resolve against the old layout, so remap everything before copying back
+  for (u32 i = 1; i < count; i++) {
+    packed[i].parent = compactRemap(tree, new_index_of, packed, packed[i].parent);
+    packed[i].first_child = compactRemap(tree, new_index_of, packed, packed[i].first_child);
+    packed[i].last_child = compactRemap(tree, new_index_of, packed, packed[i].last_child);
+    packed[i].next_sibling = compactRemap(tree, new_index_of, packed, packed[i].next_sibling);
+    packed[i].prev_sibling = compactRemap(tree, new_index_of, packed, packed[i].prev_sibling);
+  }
+  for (u32 i = 0; i < external_count; i++) {
+    *external[i] = compactRemap(tree, new_index_of, packed, *external[i]);
+  }
+  tree->root = compactRemap(tree, new_index_of, packed, tree->root);
+
+  MemoryCopy(&tree->nodes[1], &packed[1], (u64)live * sizeof(CNode));
+  for (u32 i = 1; i < count; i++) {
+    tree->handle_by_id[tree->nodes[i].id] = nodeHandleMake(i, tree->nodes[i].generation);
+  }
+  for (u32 i = count; i < old_length; i++) {
+    tree->nodes[i].generation += 1;
+    tree->nodes[i].type = NodeTypeInvalid;
+  }
+  tree->length = count;
+  tree->first_free = NODE_NIL;
+  tree->free_count = 0;
+  tree->edit_generation += 1; // no node moved in the tree, but every handle changed
+  tree->content_generation += 1;
+  arenaFree(&scratch);
+}
+
+fn CTreeLayoutStats cTreeLayoutStats(CTree* tree) {
+  CTreeLayoutStats result = {
+    .slots = tree->length - 1,
+    .free = tree->free_count,
+    .live = tree->length - 1 - tree->free_count,
+  };
+  u32 steps = 0;
+  u32 sequential = 0;
+  u32 prev_index = NODE_NIL;
+  for (NodeHandle h = tree->root; h != NODE_NIL; h = nextNodePreorder(tree, h, tree->root)) {
+    u32 index = nodeHandleIndex(h);
+    if (prev_index != NODE_NIL) {
+      steps += 1;
+      sequential += index == prev_index + 1;
+    }
+    prev_index = index;
+  }
+  result.fragmentation = result.slots > 0 ? (f32)result.free / result.slots : 0;
+  result.preorder_sequential = steps > 0 ? (f32)sequential / steps : 1;
+  return result;
+}
+
+fn CTreeClip clipCreate() {
+  CTreeClip result = {0};
+  arenaInit(&result.arena);
+  return result;
+}
+
+fn void clipRelease(CTreeClip* clip) {
+  arenaFree(&clip->arena);
+  MemoryZeroStruct(clip, CTreeClip);
+}
+
+fn StringChunk* clipChunk(StringChunk* chunks, u64 index) {
+  return (StringChunk*)((u8*)chunks + index * STRING_CHUNK_SIZE);
+}
+
+fn StringChunk* relocateChunk(StringChunk* chunk, StringChunk* from, StringChunk* to) {
+  if (chunk == NULL) return NULL;
+  return (StringChunk*)((u8*)to + ((u8*)chunk - (u8*)from));
+}
+
+fn void relocateFunctionStrings(CFnDetails* function, StringChunk* from, StringChunk* to) {
+  StringChunkList* lists[2 + 2 * arrayLen(function->args)];
+  u32 list_count = 0;
+  lists[list_count++] = &function->name;
+  lists[list_count++] = &function->return_type;
+  for (u32 i = 0; i < function->arg_count && i < arrayLen(function->args); i++) {
+    lists[list_count++] = &function->args[i].type;
+    lists[list_count++] = &function->args[i].name;
+  }
+  for (u32 i = 0; i < list_count; i++) {
+    lists[i]->first = relocateChunk(lists[i]->first, from, to);
+    lists[i]->last = relocateChunk(lists[i]->last, from, to);
+  }
+}
+
+// copies `list`'s chunks to `chunks[*next_chunk..]` and points the list at the copies
+fn void clipStringList(StringChunkList* list, StringChunk* chunks, u64* next_chunk) {
+  if (list->first == NULL) return;
+  StringChunk* first = clipChunk(chunks, *next_chunk);
+  StringChunk* copy = NULL;
+  for (StringChunk* chunk = list->first; chunk != NULL; chunk = chunk->next) {
+    copy = clipChunk(chunks, (*next_chunk)++);
+    MemoryCopy(copy, chunk, STRING_CHUNK_SIZE);
+    copy->next = chunk->next != NULL ? clipChunk(chunks, *next_chunk) : NULL;
+  }
+  list->first = first;
+  list->last = copy;
+}
+
+// replaces whatever `clip` held with a copy of `subtree_root` and everything below it
+fn void cTreeYank(CTree* tree, NodeHandle subtree_root, CTreeClip* clip) {
+  assert(subtree_root != tree->root && "can't yank the root");
+  arenaDealloc(&clip->arena, clip->arena.alloc_position);
+  clip->node_count = 0;
+  clip->function_count = 0;
+  clip->numeric_literal_count = 0;
+  clip->chunk_count = 0;
+  for (NodeHandle h = subtree_root; h != NODE_NIL; h = nextNodePreorder(tree, h, subtree_root)) {
+    CNode* node = nodeFromHandle(tree, h);
+    clip->node_count += 1;
+    if (node->type == NodeTypeFunction) {
+      CFnDetails* function = nodeFunction(tree, node);
+      clip->function_count += 1;
+      clip->chunk_count += function->name.count + function->return_type.count;
+      for (u32 i = 0; i < function->arg_count && i < arrayLen(function->args); i++) {
+        clip->chunk_count += function->args[i].type.count + function->args[i].name.count;
+      }
+    } else if (node->type == NodeTypeNumericLiteral) {
+      clip->numeric_literal_count += 1;
+    }
+  }
+  clip->nodes = arenaAllocArray(&clip->arena, CNode, clip->node_count + 1);
+  clip->functions = arenaAllocArray(&clip->arena, CFnDetails, clip->function_count + 1);
+  clip->numeric_literals = arenaAllocArray(&clip->arena, String, clip->numeric_literal_count + 1);
+  clip->chunks = (StringChunk*)arenaAlloc(&clip->arena, clip->chunk_count * STRING_CHUNK_SIZE);
+
+  // preorder again, this time rebuilding the links as clip indices
+  u32 count = 0;
+  u32 function_count = 0;
+  u32 numeric_literal_count = 0;
+  u64 chunk_count = 0;
+  u32 parent = 0;
+  NodeHandle h = subtree_root;
+  while (true) {
+    CNode* node = nodeFromHandle(tree, h);
+    u32 index = ++count;
+    CNode* copy = &clip->nodes[index];
+    MemoryZeroStruct(copy, CNode);
+    copy->type = node->type;
+    copy->flags = node->flags;
+    copy->child_count = node->child_count;
+    copy->render_start = node->render_start;
+    if (parent != 0) {
+      CNode* copy_parent = &clip->nodes[parent];
+      copy->parent = parent;
+      copy->prev_sibling = copy_parent->last_child;
+      if (copy_parent->last_child != 0) {
+        clip->nodes[copy_parent->last_child].next_sibling = index;
+      } else {
+        copy_parent->first_child = index;
+      }
+      copy_parent->last_child = index;
+    }
+    if (node->type == NodeTypeFunction) {
+      copy->payload = ++function_count;
+      CFnDetails* function = &clip->functions[copy->payload];
+      *function = *nodeFunction(tree, node);
+      clipStringList(&function->name, clip->chunks, &chunk_count);
+      clipStringList(&function->return_type, clip->chunks, &chunk_count);
+      for (u32 i = 0; i < function->arg_count && i < arrayLen(function->args); i++) {
+        clipStringList(&function->args[i].type, clip->chunks, &chunk_count);
+        clipStringList(&function->args[i].name, clip->chunks, &chunk_count);
+      }
+    } else if (node->type == NodeTypeNumericLiteral) {
+      copy->payload = ++numeric_literal_count;
+      clip->numeric_literals[copy->payload] = *nodeNumericLiteral(tree, node);
+    }
+
+    if (node->first_child != NODE_NIL) {
+      parent = index;
+      h = node->first_child;
+      continue;
+    }
+    while (h != subtree_root && nodeFromHandle(tree, h)->next_sibling == NODE_NIL) {
+      h = nodeFromHandle(tree, h)->parent;
+      parent = clip->nodes[parent].parent;
+    }
+    if (h == subtree_root) break;
+    h = nodeFromHandle(tree, h)->next_sibling;
+  }
+  assert(count == clip->node_count && chunk_count == clip->chunk_count);
+}
+
+fn NodeHandle clipHandle(CTree* tree, u32 base, u32 clip_index) {
+  if (clip_index == 0) return NODE_NIL;
+  return handleFromNode(tree, &tree->nodes[base + clip_index - 1]);
+}
+
+// inserts a copy of the clip's subtree into `parent` after `prev` (first, if that's NODE_NIL).
+// the nodes land in fresh contiguous slots in preorder and their strings in one new run of
+// chunks: a block copy of each plus relocating links and pointers, never a per-string alloc.
+fn NodeHandle cTreePaste(CTree* tree, CTreeClip* clip, StringArena* strings, NodeHandle parent, NodeHandle prev) {
+  assert(clip->node_count > 0 && "pasting an empty clip");
+  StringChunk* chunks = NULL;
+  if (clip->chunk_count > 0) {
+    chunks = allocStringChunkBlock(strings, clip->chunk_count);
+    MemoryCopy(chunks, clip->chunks, clip->chunk_count * STRING_CHUNK_SIZE);
+    for (u64 i = 0; i < clip->chunk_count; i++) {
+      StringChunk* chunk = clipChunk(chunks, i);
+      chunk->next = relocateChunk(chunk->next, clip->chunks, chunks);
+    }
+  }
+
+  // later slots still hold their old generations, so handles to them can be made before they're written
+  u32 base = allocNodeRange(tree, clip->node_count);
+  for (u32 i = 1; i <= clip->node_count; i++) {
+    CNode* node = &tree->nodes[base + i - 1];
+    u8 generation = node->generation;
+    *node = clip->nodes[i];
+    node->generation = generation;
+    node->flags |= NODE_FLAG_LAYOUT_DIRTY; // fresh slots, never laid out
+    assignNodeId(tree, base + i - 1);
+    // payloads come off the tables' free lists, which keeps them in memory that's already warm
+    if (node->type == NodeTypeFunction) {
+      CFnDetails* function = &clip->functions[node->payload];
+      node->payload = payloadAlloc(&tree->functions);
+      CFnDetails* copy = nodeFunction(tree, node);
+      *copy = *function;
+      relocateFunctionStrings(copy, clip->chunks, chunks);
+    } else if (node->type == NodeTypeNumericLiteral) {
+      String* literal = &clip->numeric_literals[node->payload];
+      node->payload = payloadAlloc(&tree->numeric_literals);
+      *nodeNumericLiteral(tree, node) = *literal;
+    }
+    node->parent = clipHandle(tree, base, node->parent);
+    node->first_child = clipHandle(tree, base, node->first_child);
+    node->last_child = clipHandle(tree, base, node->last_child);
+    node->next_sibling = clipHandle(tree, base, node->next_sibling);
+    node->prev_sibling = clipHandle(tree, base, node->prev_sibling);
+  }
+
+  NodeHandle result = clipHandle(tree, base, 1);
+  linkNodeAfter(tree, parent, prev, result);
+  return result;
+}
+
+fn NodeHandle handleFromId(CTree* tree, u32 node_id) {
+  NodeHandle result = NODE_NIL;
+  if (node_id < tree->next_id) {
+    result = tree->handle_by_id[node_id];
+  }
+  return result;
+}
+
+fn void changeNodeType(CTree* tree, NodeHandle handle, NodeType type) {
+  CNode* node = nodeFromHandle(tree, handle);
+  assert(node != &tree->nodes[NODE_NIL]);
+  NodePayloadTable* old_table = payloadTableForType(tree, node->type);
+  NodePayloadTable* new_table = payloadTableForType(tree, type);
+  if (old_table != new_table) {
+    if (old_table != NULL) {
+      payloadRelease(old_table, node->payload);
+    }
+    node->payload = new_table != NULL ? payloadAlloc(new_table) : NODE_PAYLOAD_NIL;
+  }
+  node->type = type;
+  tree->content_generation += 1;
+  markNodeDirty(tree, handle);
+}
+
+// for edits that don't go through CTree itself, like typing into a function's name
+fn void markNodeChanged(CTree* tree, NodeHandle handle) {
+  assert(nodeFromHandle(tree, handle) != &tree->nodes[NODE_NIL]);
+  tree->content_generation += 1;
+  markNodeDirty(tree, handle);
+}
+
+// flags `handle` and its ancestors for re-layout. a flagged node's ancestors are always
+// flagged too, so the walk stops at the first one that already is
+fn void markNodeDirty(CTree* tree, NodeHandle handle) {
+  while (handle != NODE_NIL) {
+    CNode* node = nodeFromHandle(tree, handle);
+    if (node->flags & NODE_FLAG_LAYOUT_DIRTY) break;
+    node->flags |= NODE_FLAG_LAYOUT_DIRTY;
+    handle = node->parent;
+  }
+}
+
+fn CFnDetails* nodeFunction(CTree* tree, CNode* node) {
+  assert(node->type == NodeTypeFunction);
+  return (CFnDetails*)payloadFromIndex(&tree->functions, node->payload);
+}
+
+fn String* nodeNumericLiteral(CTree* tree, CNode* node) {
+  assert(node->type == NodeTypeNumericLiteral);
+  return (String*)payloadFromIndex(&tree->numeric_literals, node->payload);
+}
+
+fn u64 cTreeBytesCommitted(CTree* tree) {
+  return tree->arena.commit_position
+    + tree->id_arena.commit_position
+    + tree->functions.arena.commit_position
+    + tree->numeric_literals.arena.commit_position;
+}
@@ -0,0 +1,181 @@
+#ifndef C_TREE_H
+#define C_TREE_H
+
+#include "base/all.h"
+#include "string_chunk.h"
+
+// a NodeHandle is a 32-bit generational reference into CTree.nodes:
+// the low 24 bits are the slot index, the high 8 bits are the slot's generation
+// at the time the handle was made. slot 0 is the permanently-zeroed nil node,
+// so a zeroed handle always means "no node". a slot whose generation wraps isn't
+// reused until the next compaction, so a stale handle can't come back to life.
+#define NODE_HANDLE_INDEX_BITS (24)
+#define NODE_HANDLE_INDEX_MASK ((1u << NODE_HANDLE_INDEX_BITS) - 1)
+#define NODE_HANDLE_GENERATION_MASK (0xff)
+#define NODE_POOL_MAX_NODES (1u << NODE_HANDLE_INDEX_BITS)
+#define NODE_POOL_INITIAL_CAPACITY (64)
+#define NODE_NIL (0)
+#define NODE_PAYLOAD_NIL (0)
+
+// CNode.flags
+#define NODE_FLAG_LAYOUT_DIRTY (1 << 0) // its measured size may be stale, see markNodeDirty
+
+///// TYPES
+typedef u32 NodeHandle;
+
+typedef struct Pointu32 {
+  u32 x;
+  u32 y;
+} Pointu32;
+
+typedef enum NodeType {
+  NodeTypeInvalid,
+  NodeTypeIncomplete,
+  NodeTypeRoot,
+  NodeTypeFunction,
+  NodeTypeBlock,
+  NodeTypeReturn,
+  NodeTypeNumericLiteral,
+  NodeTypeStatement,
+  NodeTypeExpression,
+  NodeType_Count
+} NodeType;
+
+typedef struct CDecl {
+  StringChunkList type;
+  StringChunkList name;
+} CDecl;
+
+typedef struct CFnDetails {
+  u8 arg_count;
+  StringChunkList name;
+  StringChunkList return_type;
+  CDecl args[16];
+} CFnDetails;
+
+// the hot part of a node: everything a traversal touches. per-type details live
+// in CTree's payload tables and are reached through `payload`, so a literal or an
+// incomplete node doesn't drag a whole CFnDetails through the cache.
+typedef struct CNode {
+  u8 type; // NodeType
+  u8 generation;
+  u16 flags;
+  u32 id;
+  u32 child_count;
+  u32 payload; // index into the payload table for `type`, NODE_PAYLOAD_NIL if it has none
+  NodeHandle parent;
+  NodeHandle first_child;
+  NodeHandle last_child;
+  NodeHandle next_sibling;
+  NodeHandle prev_sibling;
+  Pointu32 render_start;
+} CNode;
+
+// a growable array of fixed-size payloads in its own arena, so items never move.
+// item 0 is a zeroed nil payload; released items are threaded through `first_free`.
+typedef struct NodePayloadTable {
+  u32 item_size;
+  u32 capacity;
+  u32 length;
+  u32 first_free;
+  u8* items;
+  Arena arena;
+} NodePayloadTable;
+
+typedef struct CTree {
+  u32 capacity; // slots committed in `arena`
+  u32 length;   // slots handed out, including the nil slot
+  u32 next_id;
+  u32 first_free; // freed slot indices, threaded through `next_sibling`
+  u32 free_count; // slots without a node: the free list plus slots retired by freeNodeSlot
+  u64 edit_generation; // bumped by every change to the tree's shape
+  u64 content_generation; // bumped by every change that could change how the tree renders
+  NodeHandle root;
+  CNode* nodes; // never moves: `arena` reserves room for NODE_POOL_MAX_NODES up front
+  Arena arena;
+  NodePayloadTable functions;        // CFnDetails
+  NodePayloadTable numeric_literals; // String
+  // ids are never reused, so this is a dense id -> handle map. a node that goes away
+  // leaves NODE_NIL behind, so an old id can never resolve to somebody else's node.
+  // `id_arena` reserves room for NODE_POOL_MAX_NODES ids and is swapped for a larger one
+  // past that, so `handle_by_id` may move.
+  u32 id_capacity;
+  NodeHandle* handle_by_id;
+  Arena id_arena;
+} CTree;
+
+// the tree flattened in preorder. a node's descendants are the `subtree_sizes[i] - 1`
+// entries right after it, so a full walk is a linear scan and skipping a whole
+// subtree (a folded function, an off-screen region) is `i += subtree_sizes[i]`.
+// rebuilt by preorderSync whenever the tree's edit_generation moves on.
+// experimental: only the tree_preorder bench builds one so far. the editor's walks (render,
+// journal, yank) still follow the links, since they visit a view or a subtree rather than
+// the whole tree, and rebuilding after every edit would cost more than it saves there.
+typedef struct CTreePreorder {
+  u64 edit_generation; // of the tree it was last built from
+  u32 length;
+  u32 capacity;
+  NodeHandle* nodes;
+  u32* subtree_sizes; // including the node itself
+  u32* depths;        // the root is depth 0
+  u32* open;          // scratch for the build: ancestors whose subtree size isn't known yet
+  Arena arena;
+} CTreePreorder;
+
+// a subtree copied out of a CTree, ready to be pasted back in any number of times.
+// nodes are in preorder and link to each other by index into `nodes` (0 means none),
+// and the strings the subtree owns are copied into one run of chunks, so a paste is
+// one block copy of each plus relocating the links and pointers.
+typedef struct CTreeClip {
+  u32 node_count;
+  u32 function_count;
+  u32 numeric_literal_count;
+  u64 chunk_count;
+  CNode* nodes;               // [1..node_count], `payload` indexes the arrays below
+  CFnDetails* functions;      // [1..function_count], their lists point into `chunks`
+  String* numeric_literals;   // [1..numeric_literal_count], bytes are shared, not copied
+  StringChunk* chunks;        // chunk_count chunks of STRING_CHUNK_SIZE bytes, back to back
+  Arena arena;
+} CTreeClip;
+
+typedef struct CTreeLayoutStats {
+  u32 slots; // handed out, not counting the nil slot
+  u32 live;
+  u32 free;
+  f32 fragmentation;       // free / slots
+  f32 preorder_sequential; // share of preorder steps that land on the very next slot
+} CTreeLayoutStats;
+
+///// Functions()
+fn CTree cTreeCreate();
+fn void cTreeRelease(CTree* tree);
+fn void linkNodeAfter(CTree* tree, NodeHandle parent, NodeHandle prev, NodeHandle node);
+fn NodeHandle addNode(CTree* tree, NodeType type, NodeHandle parent);
+fn NodeHandle addNodeFirstChild(CTree* tree, NodeType type, NodeHandle parent);
+fn NodeHandle addNodeBeforeSibling(CTree* tree, NodeType type, NodeHandle parent, NodeHandle sibling);
+fn NodeHandle addNodeAfterSibling(CTree* tree, NodeType type, NodeHandle parent, NodeHandle sibling);
+fn void unlinkNode(CTree* tree, NodeHandle node);
+fn void deleteSubtree(CTree* tree, NodeHandle node, StringArena* strings);
+fn void cTreeCompact(CTree* tree, NodeHandle** external, u32 external_count);
+fn CTreeLayoutStats cTreeLayoutStats(CTree* tree);
+fn CTreeClip clipCreate();
+fn void clipRelease(CTreeClip* clip);
+fn void cTreeYank(CTree* tree, NodeHandle subtree_root, CTreeClip* clip);
+fn NodeHandle cTreePaste(CTree* tree, CTreeClip* clip, StringArena* strings, NodeHandle parent, NodeHandle prev);
+fn NodeHandle nextNodePreorder(CTree* tree, NodeHandle node, NodeHandle subtree_root);
+fn CTreePreorder preorderCreate();
+fn void preorderRelease(CTreePreorder* preorder);
+fn bool preorderSync(CTreePreorder* preorder, CTree* tree);
+fn NodeHandle handleFromId(CTree* tree, u32 node_id);
+fn CNode* nodeFromHandle(CTree* tree, NodeHandle handle);
+fn NodeHandle handleFromNode(CTree* tree, CNode* node);
+fn bool isNodeHandleValid(CTree* tree, NodeHandle handle);
+fn void changeNodeType(CTree* tree, NodeHandle handle, NodeType type);
+fn void markNodeChanged(CTree* tree, NodeHandle handle);
+fn void markNodeDirty(CTree* tree, NodeHandle handle);
+fn void releaseNodeStrings(CTree* tree, CNode* node, StringArena* strings);
+fn CFnDetails* nodeFunction(CTree* tree, CNode* node);
+fn String* nodeNumericLiteral(CTree* tree, CNode* node);
+fn u64 cTreeBytesCommitted(CTree* tree);
+
+#endif //C_TREE_H
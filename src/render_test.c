@@ -1,76 +1,177 @@
-#include "base/impl.c"
-#include "render.c"
+// headless frame timing: the real editor (updateAndRender + printfBufferAndSwap) driven by a
+// scripted stream of keys, with the escape codes going to a counter instead of a terminal
+//
+//   ./make.sh render_test run [p99 budget in us]
+//
+// exits 1 when the p99 frame time is over the budget, for catching regressions locally
+#define TREE_EDITOR_NO_MAIN
+#include "tree_editor.c"
+#include <stdio.h>
 
 ///// #DEFINES
-#define GOAL_LOOPS_PER_S 24
-#define GOAL_LOOP_US 1000000/GOAL_LOOPS_PER_S
-
-///// TYPES
+#define RENDER_TEST_WIDTH (200)
+#define RENDER_TEST_HEIGHT (60)
+#define RENDER_TEST_FUNCTIONS (300)
+#define RENDER_TEST_STATEMENTS (12)
+#define RENDER_TEST_FRAMES (4000)
 
 ///// GLOBALS
-global bool should_quit = false;
+// one entry per frame, "" is a frame without input
+global str RENDER_TEST_SCRIPT[] = {
+  // walk the functions on screen, and the statements inside one of them
+  "j", "j", "j", "k", "k", "k", "j", "j", "l", "j", "j", "j", "j", "j", "j", "j", "j", "j", "j",
+  "k", "k", "k", "k", "k", "k", "k", "k", "k", "k", "h", "k", "k",
+  "", "", "", "",
+  // add a function below the cursor and name it
+  "i", "f", "\t", "f", "o", "o", "_", "b", "a", "r", "\x7f", "\x1b",
+  // copy it around, undo and redo
+  "y", "p", "p", "P", "u", "u", "\x12", "\x1b[A", "d", "u",
+  // look inside it from a second view
+  "v", "l", "j", "j", "j", "w", "k", "k", "w", "h", "c",
+  "", "", "", "",
+  "k", "j", "k", "j", "l", "j", "j", "k", "h",
+  // the command palette
+  "?", "u", "n", "\x7f", "\x7f", "\x1b",
+  "", "", "", "",
+};
+global u64 RENDER_TEST_BYTES = 0;
+
+///// functions()
+fn void renderTestFlush(u8* bytes, u64 length) {
+  (void)bytes;
+  RENDER_TEST_BYTES += length;
+}
+
+// RENDER_TEST_FUNCTIONS functions of RENDER_TEST_STATEMENTS `return 0;`s each, after main()
+fn void renderTestBuildTree(State* s) {
+  String name = { .bytes = "fn", .length = 2, .capacity = 3 };
+  for (u32 f = 0; f < RENDER_TEST_FUNCTIONS; f++) {
+    NodeHandle fn_handle = addNode(&s->tree, NodeTypeFunction, s->tree.root);
+    CFnDetails* details = nodeFunction(&s->tree, nodeFromHandle(&s->tree, fn_handle));
+    details->name = allocStringChunkList(&s->string_arena, name);
+    details->return_type = allocStringChunkList(&s->string_arena, DEFAULT_RETURN_TYPE);
+    for (u32 r = 0; r < RENDER_TEST_STATEMENTS; r++) {
+      NodeHandle ret_handle = addNode(&s->tree, NodeTypeReturn, fn_handle);
+      String* literal = nodeNumericLiteral(&s->tree, nodeFromHandle(&s->tree, addNode(&s->tree, NodeTypeNumericLiteral, ret_handle)));
+      literal->bytes = "0";
+      literal->length = 1;
+      literal->capacity = 2;
+    }
+  }
+}
+
+// a return whose literal is followed by a pasted function: only the `return  0;` is drawn, and
+// nothing under the function leaks onto the screen. returns whether the view came out right
+fn bool renderTestHiddenChildren(void) {
+  CTree tree = cTreeCreate();
+  TreeLayout layout = layoutCreate();
+  ViewCache cache = viewCacheCreate();
+  NodeHandle fn_handle = addNode(&tree, NodeTypeFunction, tree.root);
+  NodeHandle ret_handle = addNode(&tree, NodeTypeReturn, fn_handle);
+  String* literal = nodeNumericLiteral(&tree, nodeFromHandle(&tree, addNode(&tree, NodeTypeNumericLiteral, ret_handle)));
+  literal->bytes = "0";
+  literal->length = 1;
+  literal->capacity = 2;
+  NodeHandle pasted = addNode(&tree, NodeTypeFunction, ret_handle);
+  addNode(&tree, NodeTypeIncomplete, pasted);
+  addNode(&tree, NodeTypeIncomplete, pasted);
+
+  str expected[] = { "int myFunction() {", "  return  0;", "}", "", "" };
+  u32 width = 40;
+  layoutSync(&layout, &tree);
+  viewCacheSync(&cache, &tree, &layout, tree.root, 0, width, arrayLen(expected));
+  bool result = true;
+  for (u32 row = 0; row < arrayLen(expected); row++) {
+    char shown[41] = {0};
+    u32 length = 0;
+    for (u32 x = 0; x < width; x++) {
+      u8 byte = cache.pixels[x + row * width].bytes[0];
+      shown[x] = byte == 0 ? ' ' : byte;
+      if (byte != 0 && byte != ' ') length = x + 1;
+    }
+    shown[length] = 0;
+    if (strcmp(shown, expected[row]) != 0) {
+      printf("  FAIL: row %u of a return with hidden children is \"%s\", expected \"%s\"\n", row, shown, expected[row]);
+      result = false;
+    }
+  }
+  viewCacheRelease(&cache);
+  layoutRelease(&layout);
+  cTreeRelease(&tree);
+  return result;
+}
+
+fn int renderTestCompareU64(const void* a, const void* b) {
+  u64 x = *(u64*)a, y = *(u64*)b;
+  return x < y ? -1 : x > y;
+}
 
 i32 main(i32 argc, ptr argv[]) {
-	osInit();
-	i32 ip = htonl(osLanIPAddress());
-	struct sockaddr_in addr = {0};
-	addr.sin_addr.s_addr = ip;
-	printf("%d %s", ip, inet_ntoa(addr.sin_addr));
-	return 0;
-  Arena permanent_arena = {0};
-  arenaInit(&permanent_arena);
-  // set up the TUI incantations
-  TermIOs old_terminal_attributes = osStartTUI(false);
-  TuiState tui = tuiInit(&permanent_arena, MAX_SCREEN_WIDTH*MAX_SCREEN_HEIGHT);
-  tui.screen_dimensions = osGetTerminalDimensions();
-
-  // init our working state
-
-  // ui loop (read input, simulate next frame, render)
+  osInit();
+  ThreadContext tctx = {0};
+  tctxInit(&tctx);
+  u64 p99_budget_us = argc > 1 ? strtoull(argv[1], NULL, 10) : 0;
+  if (!renderTestHiddenChildren()) {
+    return 1;
+  }
+
+  State state;
+  editorInit(&state);
+  renderTestBuildTree(&state);
+
+  // the same TuiState the loop would make, minus the terminal
+  Arena arena = {0};
+  arenaInit(&arena);
+  TuiState tui = tuiInit(&arena, MAX_SCREEN_WIDTH*MAX_SCREEN_HEIGHT);
+  tui.ansi.flush = renderTestFlush;
+  tui.screen_dimensions = (Dim2){ .width = RENDER_TEST_WIDTH, .height = RENDER_TEST_HEIGHT };
+
+  u64* frame_us = arenaAllocArray(&arena, u64, RENDER_TEST_FRAMES);
+  u64* frame_bytes = arenaAllocArray(&arena, u64, RENDER_TEST_FRAMES);
+  u64 touched_bytes = 0;
   u8 input_buffer[5] = {0};
-  u64 loop_start;
-  u64 loop_count = 0;
-  while (!should_quit) {
-    loop_count += 1;
-    loop_start = osTimeMicrosecondsNow();
-
-    // both reads local input from the keyboard AND from the network
-		osReadConsoleInput(input_buffer, 4);
-
-    // operate on input
-    {
-			if (input_buffer[0] == 'q') {
-				should_quit = true;
-			}
-    }
+  for (u64 frame = 0; frame < RENDER_TEST_FRAMES; frame++) {
+    // the steps infiniteUILoop takes, timed from input to the escape codes being handed off
+    MemoryZero(input_buffer, sizeof(input_buffer));
+    str keys = RENDER_TEST_SCRIPT[frame % arrayLen(RENDER_TEST_SCRIPT)];
+    MemoryCopy(input_buffer, keys, strlen(keys));
+    u64 bytes_before = RENDER_TEST_BYTES;
+    u64 start = osTimeMicrosecondsNow();
 
-    // render
-    MemoryZero(tui.frame_buffer, tui.buffer_len * sizeof(Pixel));
     tui.prev_screen_dimensions = tui.screen_dimensions;
-    if (loop_count % 17 == 0) { // every 17 frames, update our terminal_dimensions
-      tui.screen_dimensions = osGetTerminalDimensions();
-    }
-    tui.prev_cursor = tui.cursor;// save last frame's cursor
-    renderStrToBuffer(tui.frame_buffer, (1+loop_count) % 20, 1, "blah blah", tui.screen_dimensions);
-		drawAnsiBox(tui.frame_buffer, 5, 5, 5, 5, tui.screen_dimensions);
-		printf("%d %d %d %d", input_buffer[0], input_buffer[1], input_buffer[2], input_buffer[3]);
-		tui.frame_buffer[10].bytes[0] = input_buffer[0];
-		tui.frame_buffer[11].bytes[0] = input_buffer[1];
-		tui.frame_buffer[12].bytes[0] = input_buffer[2];
-		tui.frame_buffer[13].bytes[0] = input_buffer[3];
-
-		// blit
+    tuiClearFrame(&tui);
+    tui.prev_cursor = tui.cursor;
+    tui.wake_in_us = 0;
+    bool should_quit = updateAndRender(&tui, &state, input_buffer, frame + 1);
     printfBufferAndSwap(&tui);
 
-    // loop timing
-    u32 loop_duration = osTimeMicrosecondsNow() - loop_start;
-    i32 remaining_time = GOAL_LOOP_US - loop_duration;
-    if (remaining_time > 0) {
-      osSleepMicroseconds(remaining_time);
-    }
+    frame_us[frame] = osTimeMicrosecondsNow() - start;
+    frame_bytes[frame] = RENDER_TEST_BYTES - bytes_before;
+    touched_bytes += tui.stats.cleared_bytes + tui.stats.hashed_bytes + tui.stats.diffed_bytes;
+    assert(!should_quit && "the script shouldn't quit the editor");
   }
 
-  // cleanup terminal TUI incantations
-  osEndTUI(old_terminal_attributes);
+  u64 total_us = 0;
+  for (u32 i = 0; i < RENDER_TEST_FRAMES; i++) total_us += frame_us[i];
+  qsort(frame_us, RENDER_TEST_FRAMES, sizeof(u64), renderTestCompareU64);
+  qsort(frame_bytes, RENDER_TEST_FRAMES, sizeof(u64), renderTestCompareU64);
+  u64 p50 = frame_us[RENDER_TEST_FRAMES / 2];
+  u64 p99 = frame_us[RENDER_TEST_FRAMES * 99 / 100];
+
+  printf("render_test: %u frames at %ux%u, %u nodes by the end\n",
+    RENDER_TEST_FRAMES, RENDER_TEST_WIDTH, RENDER_TEST_HEIGHT, state.tree.length - state.tree.free_count);
+  printf("  frame time: mean %.1f us, p50 %llu us, p99 %llu us, max %llu us\n",
+    (f64)total_us / RENDER_TEST_FRAMES, p50, p99, frame_us[RENDER_TEST_FRAMES - 1]);
+  printf("  bytes emitted per frame: mean %.0f, p50 %llu, p99 %llu, max %llu\n",
+    (f64)RENDER_TEST_BYTES / RENDER_TEST_FRAMES, frame_bytes[RENDER_TEST_FRAMES / 2],
+    frame_bytes[RENDER_TEST_FRAMES * 99 / 100], frame_bytes[RENDER_TEST_FRAMES - 1]);
+  printf("  frame memory touched per frame: mean %.0f bytes\n", (f64)touched_bytes / RENDER_TEST_FRAMES);
+
+  editorRelease(&state);
+  arenaFree(&arena);
+  if (p99_budget_us > 0 && p99 > p99_budget_us) {
+    printf("  FAIL: p99 %llu us is over the %llu us budget\n", p99, p99_budget_us);
+    return 1;
+  }
   return 0;
 }
@@ -161,3 +161,13 @@ fn void stringChunkCopyToBuffer(StringChunkList* list, u8* buffer, u32 len) {
     buffer[i] = *((char*)(chunk + 1) + (i%STRING_CHUNK_PAYLOAD_SIZE));
   }
 }
+
+// `chunk_count` chunks back to back, straight from the arena rather than the free list,
+// for copying many lists at once. the caller fills in every chunk's `next`.
+fn StringChunk* allocStringChunkBlock(StringArena* a, u64 chunk_count) {
+  StringChunk* result = NULL;
+  lockMutex(&a->mutex); {
+    result = (StringChunk*)arenaAlloc(&a->a, chunk_count * STRING_CHUNK_SIZE);
+  } unlockMutex(&a->mutex);
+  return result;
+}
@@ -4,6 +4,7 @@
 #include "base/all.h"
 
 #define STRING_CHUNK_PAYLOAD_SIZE (64 - sizeof(StringChunk*))
+#define STRING_CHUNK_SIZE (sizeof(StringChunk) + STRING_CHUNK_PAYLOAD_SIZE)
 
 typedef struct StringChunk {
   struct StringChunk *next; // essentially a header, followed by a fixed maximum str bytes
@@ -29,5 +30,6 @@ fn void stringChunkListAppend(StringArena* a, StringChunkList* list, String stri
 fn void stringChunkListDeleteLast(StringArena* a, StringChunkList* list);
 fn StringChunkList stringChunkListInit(StringArena* a);
 fn void stringChunkCopyToBuffer(StringChunkList* list, u8* buffer, u32 len);
+fn StringChunk* allocStringChunkBlock(StringArena* a, u64 chunk_count);
 
 #endif //STRING_CHUNK_H
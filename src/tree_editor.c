@@ -1,6 +1,7 @@
 #include "base/impl.c"
-#include "lib/tui.c"
 #include "string_chunk.c"
+#include "tree_render.c"
+#include "journal.c"
 
 ///// #DEFINES
 #define MAX_SCREEN_HEIGHT 300
@@ -8,6 +9,12 @@
 #define GOAL_INPUT_LOOPS_PER_S 60
 #define GOAL_INPUT_LOOP_US 1000000/GOAL_INPUT_LOOPS_PER_S
 #define PRIMITIVE_TYPE_COUNT (30)
+#define COMPACT_MIN_FREE_NODES (1024)
+#define COMPACT_IDLE_US (250000) // how long after the last keystroke an idle compaction may run
+#define SAVED_INDICATOR_US (1600000)
+#define VIEWS_INITIAL_CAPACITY (32)
+#define TREE_PANE_X (2)
+#define TREE_PANE_Y (2)
 
 ///// TYPES
 typedef enum Command {
@@ -16,14 +23,18 @@ typedef enum Command {
   CommandQuit,
   CommandMoveToParent,
   CommandMoveToFirstChild,
+  CommandDeleteNode,
+  CommandUndo,
+  CommandRedo,
+  CommandYank,
+  CommandPasteAfter,
+  CommandPasteBefore,
+  CommandSplitView,
+  CommandNextView,
+  CommandCloseView,
   Command_Count
 } Command;
 
-typedef struct Pointu32 {
-  u32 x;
-  u32 y;
-} Pointu32;
-
 typedef enum Mode {
   ModeNormal,
   ModeEdit,
@@ -31,78 +42,34 @@ typedef enum Mode {
 } Mode;
 str MODE_STRINGS[Mode_Count] = {"Normal", "Edit"};
 
-typedef enum NodeType {
-  NodeTypeInvalid,
-  NodeTypeIncomplete,
-  NodeTypeRoot,
-  NodeTypeFunction,
-  NodeTypeBlock,
-  NodeTypeReturn,
-  NodeTypeNumericLiteral,
-  NodeTypeStatement,
-  NodeTypeExpression,
-  NodeType_Count
-} NodeType;
-
-typedef struct CDecl {
-  StringChunkList type;
-  StringChunkList name;
-} CDecl;
-
-typedef struct CFnDetails {
-  u8 arg_count;
-  StringChunkList name;
-  StringChunkList return_type;
-  CDecl args[16];
-} CFnDetails;
-
-typedef struct CNode CNode;
-struct CNode {
-  NodeType type;
-  u32 id;
-  u32 child_count;
-  u32 flags;
-  CNode* parent;
-  CNode* first_child;
-  CNode* next_sibling;
-  CNode* prev_sibling;
-  Pointu32 render_start;
-  union {
-    CFnDetails function;
-    String numeric_literal;
-  };
-};
-
-typedef struct Nodes {
-  u32 length;
-  u32 capacity;
-  CNode* nodes;
-} Nodes;
+// a pane onto the shared tree: just a subtree to show, where it's scrolled to, and
+// its rendered layout. views never copy nodes, so every pane sees every edit.
+typedef struct View {
+  NodeHandle root;
+  NodeHandle selected; // the cursor, while the view isn't the active one
+  u32 scroll_row;
+  ViewCache cache;
+} View;
 
 typedef struct Views {
   u32 length;
   u32 capacity;
   Arena arena;
-  Nodes* nodes;
+  View* items;
 } Views;
 
-typedef struct CTree {
-  u32 capacity;
-  u32 length;
-  u32 next_id;
-  CNode* nodes;
-  Arena arena;
-} CTree;
-
 typedef struct State {
   bool should_quit;
   bool pending_command;
   bool show_command_palette;
   Mode mode;
-  CNode* selected_node;
-  CNode* function_node;
-  u64 saved_on;
+  NodeHandle selected_node;
+  NodeHandle function_node;
+  u64 saved_on; // osTimeMicrosecondsNow() of the last save
   CTree tree;
+  TreeLayout layout;
+  Journal journal;
+  CTreeClip clip;
   u32 selected_view;
   Views views;
   u32 node_section;
@@ -118,23 +85,59 @@ typedef struct State {
 global const CommandPaletteCommand COMMANDS[Command_Count] = {
   { .id = 0, .display_name = "Insert Sibling Node Before (I)",
     .description = "Insert a new node on the same conceptual 'level' of the tree.",
-    .tags = {"new node", "insert", "sibling", "add node", "add item", "add element", "new item", "new element"},
+    COMMAND_TAGS("new node", "insert", "sibling", "add node", "add item", "add element", "new item", "new element"),
   },
   { .id = 1, .display_name = "Insert Sibling Node After (i)",
     .description = "Insert a new node on the same conceptual 'level' of the tree.",
-    .tags = {"new node", "insert", "sibling", "add node", "add item", "add element", "new item", "new element"},
+    COMMAND_TAGS("new node", "insert", "sibling", "add node", "add item", "add element", "new item", "new element"),
   },
   { .id = 2, .display_name = "Quit (q)",
     .description = "Quit the application.",
-    .tags = {"quit", "exit", "close"},
+    COMMAND_TAGS("quit", "exit", "close"),
   },
   { .id = 3, .display_name = "Move to Parent Node (h/←)",
     .description = "Move the cursor to the node's parent node.",
-    .tags = {"parent", "move", "up", "left"},
+    COMMAND_TAGS("parent", "move", "up", "left"),
   },
   { .id = 4, .display_name = "Move to First Child Node (l/→)",
     .description = "Move the cursor to the node's first child node.",
-    .tags = {"child", "move", "down", "right"},
+    COMMAND_TAGS("child", "move", "down", "right"),
+  },
+  { .id = 5, .display_name = "Delete Node (d)",
+    .description = "Delete the node and everything inside of it.",
+    COMMAND_TAGS("delete", "remove", "cut", "node"),
+  },
+  { .id = 6, .display_name = "Undo (u)",
+    .description = "Undo the last change to the tree.",
+    COMMAND_TAGS("undo", "revert", "back"),
+  },
+  { .id = 7, .display_name = "Redo (ctrl+r)",
+    .description = "Redo the last change that was undone.",
+    COMMAND_TAGS("redo", "again", "forward"),
+  },
+  { .id = 8, .display_name = "Yank Node (y)",
+    .description = "Copy the node and everything inside of it.",
+    COMMAND_TAGS("yank", "copy", "duplicate", "clipboard"),
+  },
+  { .id = 9, .display_name = "Paste After (p)",
+    .description = "Paste the last yanked node as the next sibling.",
+    COMMAND_TAGS("paste", "put", "duplicate", "clipboard"),
+  },
+  { .id = 10, .display_name = "Paste Before (P)",
+    .description = "Paste the last yanked node as the previous sibling.",
+    COMMAND_TAGS("paste", "put", "duplicate", "clipboard"),
+  },
+  { .id = 11, .display_name = "Split View (v)",
+    .description = "Open a new pane showing the selected node and everything inside of it.",
+    COMMAND_TAGS("split", "view", "pane", "window", "open"),
+  },
+  { .id = 12, .display_name = "Next View (w)",
+    .description = "Move the cursor to the next pane.",
+    COMMAND_TAGS("next", "view", "pane", "window", "switch"),
+  },
+  { .id = 13, .display_name = "Close View (c)",
+    .description = "Close the current pane. The first pane can't be closed.",
+    COMMAND_TAGS("close", "view", "pane", "window"),
   },
 };
 
@@ -157,295 +160,7 @@ global const String EMPTY_STRING = {
   .capacity = 1,
 };
 
-global const String DEFAULT_RETURN_TYPE = {
-  .bytes = "int",
-  .length = 3,
-  .capacity = 4,
-};
-
-global const String DEFAULT_FUNCTION_NAME = {
-  .bytes = "myFunction",
-  .length = 10,
-  .capacity = 11,
-};
-
-fn Pointu32 renderNode(TuiState* tui, u32 pos, CNode* node);
-
 ///// functions()
-fn Pointu32 decompose(u32 pos, u32 width) {
-  Pointu32 result = {
-    .x = pos % width,
-    .y = pos / width,
-  };
-  return result;
-}
-
-fn CTree cTreeCreate() {
-  CTree result = {
-    .capacity = 64,
-    .length = 0,
-  };
-  arenaInit(&result.arena);
-  result.nodes = arenaAllocArray(&result.arena, CNode, result.capacity);
-  CNode root_node = {
-    .type = NodeTypeRoot,
-    .id = result.length++,
-  };
-  root_node.parent = result.nodes; // points back to self
-  result.nodes[0] = root_node;
-  return result;
-}
-
-fn CNode* addNode(CTree* tree, NodeType type, CNode* parent) {
-  if (tree->capacity == tree->length) {
-    arenaAllocArray(&tree->arena, CNode, tree->capacity);
-    tree->capacity *= 2;
-  }
-  CNode* node = &tree->nodes[tree->length++];
-  node->id = tree->next_id++;
-  node->type = type;
-  node->parent = parent;
-  if (parent->child_count == 0) {
-    assert(parent->first_child == NULL);
-    parent->first_child = node;
-  } else {
-    CNode* last_sibling = parent->first_child;
-    while (last_sibling->next_sibling != NULL) {
-      last_sibling = last_sibling->next_sibling;
-    }
-    assert(last_sibling->next_sibling == NULL);
-    last_sibling->next_sibling = node;
-    node->prev_sibling = last_sibling;
-  }
-  parent->child_count += 1;
-
-  return node;
-}
-
-fn CNode* addNodeBeforeSibling(CTree* tree, NodeType type, CNode* parent, CNode* sibling) {
-  if (tree->capacity == tree->length) {
-    arenaAllocArray(&tree->arena, CNode, tree->capacity);
-    tree->capacity *= 2;
-  }
-  CNode* node = &tree->nodes[tree->length++];
-  node->id = tree->next_id++;
-  node->type = type;
-  node->parent = parent;
-  node->next_sibling = sibling;
-  if (parent->child_count == 0) {
-    assert(parent->first_child == NULL);
-    parent->first_child = node;
-  } else {
-    CNode* iter = parent->first_child;
-    if (iter == sibling) {
-      parent->first_child = node;
-      node->prev_sibling = NULL;
-      sibling->prev_sibling = node;
-    } else {
-      while (iter->next_sibling != NULL) {
-        if (iter->next_sibling == sibling) {
-          iter->next_sibling = node;
-          sibling->prev_sibling = iter;
-          node->prev_sibling = iter;
-          break;
-        }
-        iter = iter->next_sibling;
-      }
-    }
-  }
-  parent->child_count += 1;
-
-  return node;
-}
-
-fn CNode getNode(CTree* tree, u32 node_id) {
-  CNode result = {0};
-  for (u32 i = 0; i < tree->length; i++) {
-    if (tree->nodes[i].id == node_id) {
-      return tree->nodes[i];
-    }
-  }
-  return result;
-}
-
-fn Pointu32 renderNumericLiteralNode(TuiState* tui, u32 x, u32 y, CNode* node) {
-  assert(node->type == NodeTypeNumericLiteral);
-  Pointu32 result = {.y = 1,};
-  node->render_start.x = x;
-  node->render_start.y = y;
-
-  u32 pos = x + (y*tui->screen_dimensions.width);
-  for (u32 i = 0; i < node->numeric_literal.length; i++) {
-    tui->frame_buffer[pos+i].foreground = ANSI_HIGHLIGHT_RED;
-  }
-  renderStrToBuffer(
-    tui->frame_buffer,
-    x,
-    y,
-    node->numeric_literal.bytes,
-    tui->screen_dimensions
-  );
-  result.x += node->numeric_literal.length;
-
-  return result;
-}
-
-fn Pointu32 renderReturnNode(TuiState* tui, u32 pos, CNode* node) {
-  assert(node->type == NodeTypeReturn);
-
-  Pointu32 result = {.y = 1,};
-  node->render_start.x = decompose(pos, tui->screen_dimensions.width).x;
-  node->render_start.y = decompose(pos, tui->screen_dimensions.width).y;
-
-  tui->frame_buffer[pos+(result.x)].foreground = ANSI_HIGHLIGHT_YELLOW;
-  tui->frame_buffer[pos+(result.x++)].bytes[0] = 'r';
-  tui->frame_buffer[pos+(result.x)].foreground = ANSI_HIGHLIGHT_YELLOW;
-  tui->frame_buffer[pos+(result.x++)].bytes[0] = 'e';
-  tui->frame_buffer[pos+(result.x)].foreground = ANSI_HIGHLIGHT_YELLOW;
-  tui->frame_buffer[pos+(result.x++)].bytes[0] = 't';
-  tui->frame_buffer[pos+(result.x)].foreground = ANSI_HIGHLIGHT_YELLOW;
-  tui->frame_buffer[pos+(result.x++)].bytes[0] = 'u';
-  tui->frame_buffer[pos+(result.x)].foreground = ANSI_HIGHLIGHT_YELLOW;
-  tui->frame_buffer[pos+(result.x++)].bytes[0] = 'r';
-  tui->frame_buffer[pos+(result.x)].foreground = ANSI_HIGHLIGHT_YELLOW;
-  tui->frame_buffer[pos+(result.x++)].bytes[0] = 'n';
-  tui->frame_buffer[pos+(result.x)].foreground = ANSI_HIGHLIGHT_YELLOW;
-  tui->frame_buffer[pos+(result.x++)].bytes[0] = ' ';
-
-  CNode* child = node->first_child;
-  if (child && child->type == NodeTypeNumericLiteral && child->numeric_literal.length <= 6) {
-    Pointu32 decomp = decompose(pos + result.x, tui->screen_dimensions.width);
-    Pointu32 used = renderNumericLiteralNode(tui, decomp.x + 1, decomp.y, child);
-    tui->frame_buffer[pos+result.x+child->numeric_literal.length+1].bytes[0] = ';';
-    result.x += used.x+1;
-  }
-
-  return result;
-}
-
-fn Pointu32 renderFunctionNode(TuiState* tui, u16 x, u16 y, CNode* node) {
-  assert(node->type == NodeTypeFunction);
-
-  Pointu32 result = {.y = 1,};
-  node->render_start.x = x;
-  node->render_start.y = y;
-  u32 pos = x + (y*tui->screen_dimensions.width);
-
-  // print function's return type
-  if (node->function.return_type.total_size > 0) {
-    renderStringChunkList(tui, &node->function.return_type, x+result.x, y);
-    // and color it green
-    for (u32 i = 0; i < node->function.return_type.total_size; i++) {
-      tui->frame_buffer[pos+result.x+i].foreground = ANSI_HIGHLIGHT_GREEN;
-    }
-    result.x += node->function.return_type.total_size;
-  } else {
-    for (u32 i = 0; i < DEFAULT_RETURN_TYPE.length; i++) {
-      tui->frame_buffer[pos+result.x+i].foreground = ANSI_DULL_GREEN;
-      tui->frame_buffer[pos+result.x+i].bytes[0] = DEFAULT_RETURN_TYPE.bytes[i];
-    }
-    result.x += DEFAULT_RETURN_TYPE.length;
-  }
-  result.x += 1; // space
-  // print function's name
-  if (node->function.name.total_size > 0) {
-    renderStringChunkList(tui, &node->function.name, x+result.x, y);
-    result.x += node->function.name.total_size;
-  } else {
-    for (u32 i = 0; i < DEFAULT_FUNCTION_NAME.length; i++) {
-      tui->frame_buffer[pos+result.x+i].foreground = ANSI_DULL_GRAY;
-      tui->frame_buffer[pos+result.x+i].bytes[0] = DEFAULT_FUNCTION_NAME.bytes[i];
-    }
-    result.x += DEFAULT_FUNCTION_NAME.length;
-  }
-  tui->frame_buffer[pos+result.x++].bytes[0] = '(';
-  tui->frame_buffer[pos+result.x++].bytes[0] = ')';
-  result.x += 1; // space
-  tui->frame_buffer[pos+result.x++].bytes[0] = '{';
-
-  // recursively print the children
-  for (CNode* child = node->first_child; child != NULL; child = child->next_sibling) {
-    pos = x+2 + ((y+(result.y))*tui->screen_dimensions.width);
-    Pointu32 used = renderNode(tui, pos, child);
-    result.y += used.y;
-  }
-
-  // print final closing brace
-  pos = x + (y*tui->screen_dimensions.width);
-  tui->frame_buffer[pos+((result.y++) * tui->screen_dimensions.width)].bytes[0] = '}';
-
-  result.y++; // final trailing empty line for visual appeal
-
-  return result;
-}
-
-fn Pointu32 renderBlockNode(TuiState* tui, u32 pos, CNode* node) {
-  assert(node->type == NodeTypeBlock);
-
-  u32 width = tui->screen_dimensions.width;
-  Pointu32 result = {.y = 1,};
-  node->render_start.x = decompose(pos, width).x;
-  node->render_start.y = decompose(pos, width).y;
-
-  tui->frame_buffer[pos+(result.x++)].bytes[0] = '{';
-  tui->frame_buffer[pos+(result.y*width)].bytes[0] = '}';
-
-  CNode* child = node->first_child;
-  if (child && child->type == NodeTypeNumericLiteral && child->numeric_literal.length <= 6) {
-    Pointu32 decomp = decompose(pos + result.x, tui->screen_dimensions.width);
-    Pointu32 used = renderNumericLiteralNode(tui, decomp.x + 1, decomp.y, child);
-    tui->frame_buffer[pos+result.x+child->numeric_literal.length+1].bytes[0] = ';';
-    result.x += used.x+1;
-  }
-
-  return result;
-}
-
-fn Pointu32 renderNode(TuiState* tui, u32 pos, CNode* node) {
-  Pointu32 decomp = decompose(pos, tui->screen_dimensions.width);
-  Pointu32 result = {0};
-  node->render_start.x = decomp.x;
-  node->render_start.y = decomp.y;
-
-  switch (node->type) {
-    case NodeTypeRoot: {
-      u32 inc = 0;
-      for (CNode* n = node->first_child; n != NULL; n = n->next_sibling) {
-        Pointu32 used = renderNode(tui, pos+inc, n);
-        result.y += used.y;
-        result.x = Max(result.x, used.x);
-        inc += (used.y * tui->screen_dimensions.width);
-      }
-    } break;
-    case NodeTypeInvalid:
-    case NodeType_Count:
-      break;
-    case NodeTypeFunction:
-      return renderFunctionNode(tui, decomp.x, decomp.y, node);
-    case NodeTypeReturn:
-      return renderReturnNode(tui, pos, node);
-    case NodeTypeNumericLiteral:
-      return renderReturnNode(tui, pos, node);
-    case NodeTypeBlock:
-      return renderBlockNode(tui, pos, node);
-    case NodeTypeIncomplete: {
-      //if () {
-      //}
-      // TODO render this with foreground ANSI_DULL_GRAY if the node is the currently selected node AND we are in insert mode
-      //tui->frame_buffer[pos].foreground = ANSI_DULL_GRAY;
-      tui->frame_buffer[pos].bytes[0] = '_';
-      tui->frame_buffer[pos+1].bytes[0] = '_';
-      tui->frame_buffer[pos+2].bytes[0] = '_';
-      tui->frame_buffer[pos+3].bytes[0] = '_';
-      result.x += 4;
-      result.y += 1;
-      return result;
-    } break;
-  }
-
-  return result;
-}
-
 fn PtrArray listMatchingTypes(Arena* a, StringChunkList list) {
   String type_name = stringChunkToString(a, list);
   u32 matching_count = 0;
@@ -470,26 +185,149 @@ fn PtrArray listMatchingTypes(Arena* a, StringChunkList list) {
   return result;
 }
 
+// whether `ancestor` is `node` or one of its ancestors
+fn bool isNodeUnder(CTree* tree, NodeHandle node, NodeHandle ancestor) {
+  // the root is its own parent, so stop there instead of following it forever
+  for (NodeHandle h = node; h != NODE_NIL; h = nodeFromHandle(tree, h)->parent) {
+    if (h == ancestor) return true;
+    if (h == tree->root) break;
+  }
+  return false;
+}
+
+fn View* activeView(State* s) {
+  return &s->views.items[s->selected_view];
+}
+
+fn void switchView(State* s, u32 index) {
+  activeView(s)->selected = s->selected_node;
+  s->selected_view = index;
+  s->selected_node = activeView(s)->selected;
+}
+
+fn void openView(State* s, NodeHandle root) {
+  if (s->views.length == s->views.capacity) {
+    View* added = arenaAllocArray(&s->views.arena, View, s->views.capacity); // extends `views.items` in place
+    assert(added == s->views.items + s->views.capacity && "views arena holds only the views");
+    MemoryZero(added, s->views.capacity * sizeof(View));
+    s->views.capacity *= 2;
+  }
+  View* view = &s->views.items[s->views.length];
+  if (view->cache.arena.memory == NULL) { // closed views keep their cache around for the next one
+    view->cache = viewCacheCreate();
+  }
+  view->root = root;
+  view->selected = root;
+  view->scroll_row = 0;
+  switchView(s, s->views.length++);
+}
+
+fn void closeView(State* s, u32 index) {
+  assert(index > 0 && "the first view always shows the whole tree");
+  if (index == s->selected_view) {
+    switchView(s, index - 1);
+  } else if (index < s->selected_view) {
+    s->selected_view -= 1;
+  }
+  View closed = s->views.items[index];
+  for (u32 v = index; v + 1 < s->views.length; v++) {
+    s->views.items[v] = s->views.items[v+1];
+  }
+  s->views.length -= 1;
+  s->views.items[s->views.length] = closed;
+}
+
 fn bool doCommand(State* s, u32 cmd_id) {
   bool result = true;
   Command cmd_type = (Command)cmd_id;
+  CNode* selected = nodeFromHandle(&s->tree, s->selected_node);
+  // the view's root stands in for the tree's root: new nodes go inside it, not next to it
+  NodeHandle view_root = activeView(s)->root;
   switch (cmd_type) {
     case CommandInsertSiblingAfter: {
       // insert sibling BELOW
       s->mode = ModeEdit;
-      s->selected_node = addNode(&s->tree, NodeTypeIncomplete, s->selected_node->parent);
+      if (s->selected_node == view_root) { // the root has no siblings, so add to its children instead
+        s->selected_node = journalInsertNode(&s->journal, &s->tree, &s->string_arena, NodeTypeIncomplete, view_root, selected->last_child);
+      } else {
+        s->selected_node = journalInsertNode(&s->journal, &s->tree, &s->string_arena, NodeTypeIncomplete, selected->parent, s->selected_node);
+      }
     } break;
     case CommandInsertSiblingBefore: {
       // insert sibling ABOVE
       s->mode = ModeEdit;
-      s->selected_node = addNodeBeforeSibling(&s->tree, NodeTypeIncomplete, s->selected_node->parent, s->selected_node);
+      if (s->selected_node == view_root) {
+        s->selected_node = journalInsertNode(&s->journal, &s->tree, &s->string_arena, NodeTypeIncomplete, view_root, NODE_NIL);
+      } else {
+        s->selected_node = journalInsertNode(&s->journal, &s->tree, &s->string_arena, NodeTypeIncomplete, selected->parent, selected->prev_sibling);
+      }
     } break;
     case CommandMoveToParent: {
-      s->selected_node = s->selected_node->parent;
+      if (s->selected_node != view_root) {
+        s->selected_node = selected->parent;
+      }
     } break;
     case CommandMoveToFirstChild: {
-      if (s->selected_node->first_child != NULL) {
-        s->selected_node = s->selected_node->first_child;
+      if (selected->first_child != NODE_NIL) {
+        s->selected_node = selected->first_child;
+      }
+    } break;
+    case CommandDeleteNode: {
+      if (s->selected_node == s->tree.root) {
+        break; // TODO message that you can't delete the root node
+      }
+      NodeHandle deleted = s->selected_node;
+      if (selected->next_sibling != NODE_NIL) {
+        s->selected_node = selected->next_sibling;
+      } else if (selected->prev_sibling != NODE_NIL) {
+        s->selected_node = selected->prev_sibling;
+      } else {
+        s->selected_node = selected->parent;
+      }
+      journalDeleteNode(&s->journal, &s->tree, &s->string_arena, deleted);
+    } break;
+    case CommandUndo: {
+      NodeHandle focus = journalUndo(&s->journal, &s->tree, &s->string_arena);
+      if (focus != NODE_NIL) {
+        s->selected_node = focus;
+      }
+    } break;
+    case CommandRedo: {
+      NodeHandle focus = journalRedo(&s->journal, &s->tree, &s->string_arena);
+      if (focus != NODE_NIL) {
+        s->selected_node = focus;
+      }
+    } break;
+    case CommandYank: {
+      if (s->selected_node != s->tree.root) {
+        cTreeYank(&s->tree, s->selected_node, &s->clip);
+      }
+    } break;
+    case CommandPasteAfter: {
+      if (s->clip.node_count == 0) break;
+      if (s->selected_node == view_root) {
+        s->selected_node = journalPaste(&s->journal, &s->tree, &s->string_arena, &s->clip, view_root, selected->last_child);
+      } else {
+        s->selected_node = journalPaste(&s->journal, &s->tree, &s->string_arena, &s->clip, selected->parent, s->selected_node);
+      }
+    } break;
+    case CommandPasteBefore: {
+      if (s->clip.node_count == 0) break;
+      if (s->selected_node == view_root) {
+        s->selected_node = journalPaste(&s->journal, &s->tree, &s->string_arena, &s->clip, view_root, NODE_NIL);
+      } else {
+        s->selected_node = journalPaste(&s->journal, &s->tree, &s->string_arena, &s->clip, selected->parent, selected->prev_sibling);
+      }
+    } break;
+    case CommandSplitView: {
+      openView(s, s->selected_node);
+    } break;
+    case CommandNextView: {
+      switchView(s, (s->selected_view + 1) % s->views.length);
+    } break;
+    case CommandCloseView: {
+      if (s->selected_view > 0) {
+        closeView(s, s->selected_view);
       }
     } break;
     case CommandQuit: {
@@ -508,20 +346,84 @@ fn bool updateAndRender(TuiState* tui, void* state, u8* input_buffer, u64 loop_c
   State* s = (State*)state;
   ScratchMem scratch = scratchGet();
 
+  // re-pack the node pool while the user isn't typing, once enough deleted slots pile up
+  bool idle = input_buffer[0] == 0;
+  bool needs_compaction = s->tree.free_count >= COMPACT_MIN_FREE_NODES && s->tree.free_count * 4 >= s->tree.length;
+  if (!idle && needs_compaction) {
+    tui->wake_in_us = COMPACT_IDLE_US; // the loop may not come around again until the next key
+  }
+  if (idle && needs_compaction) {
+    u32 external_count = 2 + 2*s->views.length;
+    NodeHandle** external = arenaAllocArray(&scratch.arena, NodeHandle*, external_count);
+    external_count = 0;
+    external[external_count++] = &s->selected_node;
+    external[external_count++] = &s->function_node;
+    for (u32 v = 0; v < s->views.length; v++) {
+      external[external_count++] = &s->views.items[v].root;
+      external[external_count++] = &s->views.items[v].selected;
+    }
+    cTreeCompact(&s->tree, external, external_count);
+  }
+
+  // a view whose root was deleted (or undone away) has nothing left to show
+  for (u32 v = s->views.length - 1; v > 0; v--) {
+    NodeHandle root = s->views.items[v].root;
+    if (!isNodeHandleValid(&s->tree, root) || !isNodeUnder(&s->tree, root, s->tree.root)) {
+      closeView(s, v);
+    }
+  }
+  // an undo or a delete can move the cursor out of the view
+  if (!isNodeHandleValid(&s->tree, s->selected_node) || !isNodeUnder(&s->tree, s->selected_node, activeView(s)->root)) {
+    s->selected_node = activeView(s)->root;
+  }
+
   // "always" rendering logic
   // indicate if we saved
-  if (s->saved_on && (loop_count - s->saved_on < 100)) {
+  u64 now = osTimeMicrosecondsNow();
+  if (s->saved_on && (now - s->saved_on < SAVED_INDICATOR_US)) {
     renderStrToBuffer(tui->frame_buffer, 1, 0, "saved", tui->screen_dimensions);
+    tui->wake_in_us = SAVED_INDICATOR_US - (now - s->saved_on); // to take it down again
   }
   // indicate what mode we are in
   renderStrToBuffer(tui->frame_buffer, 0, 0, MODE_STRINGS[s->mode], tui->screen_dimensions);
   // MAIN RENDER of CODE TREE
-  for (u32 i = 0; i < s->views.nodes[s->selected_view].length; i++) {
-    CNode* node = &s->views.nodes[s->selected_view].nodes[i];
-    renderNode(tui, 2 + (2*tui->screen_dimensions.width), node);
+  layoutSync(&s->layout, &s->tree);
+  // the views share the space below the status line as side by side panes
+  Dim2 sd = tui->screen_dimensions;
+  u32 pane_area_width = sd.width > TREE_PANE_X ? sd.width - TREE_PANE_X : 0;
+  u32 separators = s->views.length - 1;
+  u32 pane_width = pane_area_width > separators ? (pane_area_width - separators) / s->views.length : 0;
+  u32 pane_height = sd.height > TREE_PANE_Y ? sd.height - TREE_PANE_Y : 0;
+  Pointu32 selected_at = {0}; // where the cursor node is on screen
+  for (u32 v = 0; v < s->views.length; v++) {
+    View* view = &s->views.items[v];
+    Box pane = { .x = TREE_PANE_X + v*(pane_width + 1), .y = TREE_PANE_Y, .width = pane_width, .height = pane_height };
+    // don't leave the view scrolled past its end after a delete shrinks it
+    u32 content_height = s->layout.nodes[nodeHandleIndex(view->root)].height;
+    if (view->scroll_row + pane.height > content_height) {
+      view->scroll_row = content_height > pane.height ? content_height - pane.height : 0;
+    }
+    if (v == s->selected_view) {
+      Pointu32 at = layoutPosition(&s->layout, &s->tree, s->selected_node, view->root);
+      if (at.y < view->scroll_row) {
+        view->scroll_row = at.y;
+      } else if (pane.height > 0 && at.y >= view->scroll_row + pane.height) {
+        view->scroll_row = at.y - pane.height + 1;
+      }
+      selected_at.x = pane.x + at.x;
+      selected_at.y = pane.y + at.y - view->scroll_row;
+    }
+    viewCacheSync(&view->cache, &s->tree, &s->layout, view->root, view->scroll_row, pane.width, pane.height);
+    viewCacheBlit(&view->cache, tui, pane.x, pane.y);
+    if (v > 0 && pane.x - 1 < sd.width) {
+      for (u32 y = pane.y; y < sd.height; y++) {
+        tui->frame_buffer[pane.x - 1 + y*sd.width].bytes[0] = '|';
+      }
+    }
   }
-  tui->cursor.x = s->selected_node->render_start.x;
-  tui->cursor.y = s->selected_node->render_start.y;
+  CNode* selected = nodeFromHandle(&s->tree, s->selected_node);
+  tui->cursor.x = selected_at.x;
+  tui->cursor.y = selected_at.y;
 
   // input/mode-dependent rendering logic
   String input_string = {
@@ -579,17 +481,35 @@ fn bool updateAndRender(TuiState* tui, void* state, u8* input_buffer, u64 loop_c
         } else if (right_arrow_pressed || input_buffer[0] == 'l') {
           doCommand(s, (u32)CommandMoveToFirstChild);
         } else if (down_arrow_pressed || input_buffer[0] == 'j') {
-          if (s->selected_node->next_sibling != NULL) {
-            s->selected_node = s->selected_node->next_sibling;
+          if (selected->next_sibling != NODE_NIL) {
+            s->selected_node = selected->next_sibling;
           }
         } else if (up_arrow_pressed || input_buffer[0] == 'k') {
-          if (s->selected_node->prev_sibling != NULL) {
-            s->selected_node = s->selected_node->prev_sibling;
+          if (selected->prev_sibling != NODE_NIL) {
+            s->selected_node = selected->prev_sibling;
           }
         } else if (input_buffer[0] == 'I' && input_buffer[1] == 0) {
           doCommand(s, (u32)CommandInsertSiblingBefore);
         } else if (input_buffer[0] == 'i' && input_buffer[1] == 0) {
           doCommand(s, (u32)CommandInsertSiblingAfter);
+        } else if (input_buffer[0] == 'd' && input_buffer[1] == 0) {
+          doCommand(s, (u32)CommandDeleteNode);
+        } else if (input_buffer[0] == 'u' && input_buffer[1] == 0) {
+          doCommand(s, (u32)CommandUndo);
+        } else if (input_buffer[0] == ASCII_CTRL_R && input_buffer[1] == 0) {
+          doCommand(s, (u32)CommandRedo);
+        } else if (input_buffer[0] == 'y' && input_buffer[1] == 0) {
+          doCommand(s, (u32)CommandYank);
+        } else if (input_buffer[0] == 'p' && input_buffer[1] == 0) {
+          doCommand(s, (u32)CommandPasteAfter);
+        } else if (input_buffer[0] == 'P' && input_buffer[1] == 0) {
+          doCommand(s, (u32)CommandPasteBefore);
+        } else if (input_buffer[0] == 'v' && input_buffer[1] == 0) {
+          doCommand(s, (u32)CommandSplitView);
+        } else if (input_buffer[0] == 'w' && input_buffer[1] == 0) {
+          doCommand(s, (u32)CommandNextView);
+        } else if (input_buffer[0] == 'c' && input_buffer[1] == 0) {
+          doCommand(s, (u32)CommandCloseView);
         } else if (input_buffer[0] == 'e' && input_buffer[1] == 0) {
           s->mode = ModeEdit;
         } else if (input_buffer[0] == 'S' && input_buffer[1] == 0) {
@@ -608,7 +528,7 @@ fn bool updateAndRender(TuiState* tui, void* state, u8* input_buffer, u64 loop_c
           } else {
             osFileCreateWrite(filename, data);
           }
-          saved_on = loop_count;
+          saved_on = osTimeMicrosecondsNow();
           */
         }
       }
@@ -616,16 +536,18 @@ fn bool updateAndRender(TuiState* tui, void* state, u8* input_buffer, u64 loop_c
     case ModeEdit: {
       if (input_buffer[0] == ASCII_ESCAPE && input_buffer[1] == 0) {
         s->mode = ModeNormal;
+        journalBreakRun(&s->journal); // the next session of typing undoes separately
       }
-      switch (s->selected_node->type) {
+      // the selection may have changed since the top of the frame (e.g. via the command palette)
+      selected = nodeFromHandle(&s->tree, s->selected_node);
+      switch (selected->type) {
         case NodeTypeIncomplete: {
           // handle input
           if (input_buffer[0] == 'f' && input_buffer[1] == 0) {
-            s->selected_node->type = NodeTypeFunction;
-            s->selected_node->function.name = allocStringChunkList(&s->string_arena, EMPTY_STRING);
-            s->selected_node->function.return_type = allocStringChunkList(&s->string_arena, EMPTY_STRING);
+            // a fresh function payload starts with an empty name and return type
+            journalChangeType(&s->journal, &s->tree, &s->string_arena, s->selected_node, NodeTypeFunction);
           } else if (input_buffer[0] == 'r' && input_buffer[1] == 0) {
-            s->selected_node->type = NodeTypeReturn;
+            journalChangeType(&s->journal, &s->tree, &s->string_arena, s->selected_node, NodeTypeReturn);
           }
 
           // render
@@ -637,6 +559,7 @@ fn bool updateAndRender(TuiState* tui, void* state, u8* input_buffer, u64 loop_c
           renderStrToBuffer(tui->frame_buffer, 20, 0, ": return", tui->screen_dimensions);
         } break;
         case NodeTypeFunction: {
+          CFnDetails* function = nodeFunction(&s->tree, selected);
           // handle input
           if (s->node_section == 0) { // editing fn declaration return type section
             if (down_arrow_pressed) {
@@ -644,30 +567,29 @@ fn bool updateAndRender(TuiState* tui, void* state, u8* input_buffer, u64 loop_c
             } else if (up_arrow_pressed) {
               s->menu_index -= 1;
             } else if (tab_pressed || enter_pressed) {
-              PtrArray matching_types = listMatchingTypes(&scratch.arena, s->selected_node->function.return_type);
+              PtrArray matching_types = listMatchingTypes(&scratch.arena, function->return_type);
               //printf("%d", matching_types.length);
-              releaseStringChunkList(&s->string_arena, &s->selected_node->function.return_type);
               String temp = {
                 .bytes = matching_types.items[s->menu_index],
                 .length = strlen(matching_types.items[s->menu_index]),
                 .capacity = strlen(matching_types.items[s->menu_index]) + 1,
               };
-              s->selected_node->function.return_type = allocStringChunkList(&s->string_arena, temp);
+              journalReplaceText(&s->journal, &s->tree, &s->string_arena, s->selected_node, TextFieldFunctionReturnType, temp);
               s->menu_index = 0;
               s->node_section += 1;
             } else if (isAlphaUnderscoreSpace(input_buffer[0])) {
-              stringChunkListAppend(&s->string_arena, &s->selected_node->function.return_type, input_string);
+              journalAppendText(&s->journal, &s->tree, &s->string_arena, s->selected_node, TextFieldFunctionReturnType, input_string);
             } else if (backspace_pressed) {
-              stringChunkListDeleteLast(&s->string_arena, &s->selected_node->function.return_type);
+              journalDeleteText(&s->journal, &s->tree, &s->string_arena, s->selected_node, TextFieldFunctionReturnType);
             }
           } else if (s->node_section == 1) { // editing fn declaration identifier/name section
             if (backspace_pressed) {
-              stringChunkListDeleteLast(&s->string_arena, &s->selected_node->function.name);
+              journalDeleteText(&s->journal, &s->tree, &s->string_arena, s->selected_node, TextFieldFunctionName);
             } else if (enter_pressed || tab_pressed) {
-              s->selected_node->function.arg_count += 1;
+              function->arg_count += 1;
               s->node_section += 1;
             } else if (isSimplePrintable(input_buffer[0])) {
-              stringChunkListAppend(&s->string_arena, &s->selected_node->function.name, input_string);
+              journalAppendText(&s->journal, &s->tree, &s->string_arena, s->selected_node, TextFieldFunctionName, input_string);
             }
           } else { // editing fn decl args list
           }
@@ -676,10 +598,10 @@ fn bool updateAndRender(TuiState* tui, void* state, u8* input_buffer, u64 loop_c
           renderStrToBuffer(tui->frame_buffer, 8, 0, "Choose Function Return Type", tui->screen_dimensions);
           renderStrToBuffer(tui->frame_buffer, 40, 0, "Name Function", tui->screen_dimensions);
           if (s->node_section == 0) { // editing fn declaration return type section
-            tui->cursor.x = s->selected_node->render_start.x + s->selected_node->function.return_type.total_size;
-            tui->cursor.y = s->selected_node->render_start.y;
-            PtrArray matching_types = listMatchingTypes(&scratch.arena, s->selected_node->function.return_type);
-            u32 pos = s->selected_node->render_start.x + (tui->screen_dimensions.width * (s->selected_node->render_start.y+1));
+            tui->cursor.x = selected_at.x + function->return_type.total_size;
+            tui->cursor.y = selected_at.y;
+            PtrArray matching_types = listMatchingTypes(&scratch.arena, function->return_type);
+            u32 pos = selected_at.x + (tui->screen_dimensions.width * (selected_at.y+1));
             u32 list_size = Min(matching_types.length, 5);
             u32 goal_i = list_size;
             if (s->menu_index > (list_size/2)) {
@@ -703,10 +625,10 @@ fn bool updateAndRender(TuiState* tui, void* state, u8* input_buffer, u64 loop_c
               }
             }
           } else if (s->node_section == 1) { // editing fn declaration identifier/name section
-            tui->cursor.x = s->selected_node->render_start.x + s->selected_node->function.return_type.total_size + 1 + s->selected_node->function.name.total_size;
-            tui->cursor.y = s->selected_node->render_start.y;
-            u32 pos = tui->cursor.x + (tui->screen_dimensions.width * (s->selected_node->render_start.y));
-            for (u32 i = 0; i < s->selected_node->function.name.total_size; i++) {
+            tui->cursor.x = selected_at.x + function->return_type.total_size + 1 + function->name.total_size;
+            tui->cursor.y = selected_at.y;
+            u32 pos = tui->cursor.x + (tui->screen_dimensions.width * (selected_at.y));
+            for (u32 i = 0; i < function->name.total_size; i++) {
               tui->frame_buffer[pos+i].foreground = ANSI_DULL_GRAY;
             }
           }
@@ -734,53 +656,83 @@ fn bool updateAndRender(TuiState* tui, void* state, u8* input_buffer, u64 loop_c
   return s->should_quit;
 }
 
-i32 main(i32 argc, ptr argv[]) {
-  osInit();
-  ThreadContext tctx = {0};
-  tctxInit(&tctx);
-  // init state
-  State state = {
+// everything the editor starts with: one view over a tree holding `int main() { return 0; }`
+fn void editorInit(State* state) {
+  *state = (State){
     .should_quit = false,
     .pending_command = false,
     .mode = ModeNormal,
   };
-  arenaInit(&state.permanent_arena);
+  arenaInit(&state->permanent_arena);
 
-  arenaInit(&state.string_arena.a);
-  state.string_arena.mutex = newMutex();
+  arenaInit(&state->string_arena.a);
+  state->string_arena.mutex = newMutex();
 
-  state.commands.length = Command_Count;
-  state.commands.items = arenaAllocArray(&state.permanent_arena, CommandPaletteCommand, state.commands.length);
-  for (u32 i = 0; i < state.commands.length; i++) {
-    state.commands.items[i] = COMMANDS[i];
+  state->commands.length = Command_Count;
+  state->commands.items = arenaAllocArray(&state->permanent_arena, CommandPaletteCommand, state->commands.length);
+  for (u32 i = 0; i < state->commands.length; i++) {
+    state->commands.items[i] = COMMANDS[i];
   }
-  state.cmd_palette_search_input = allocStringChunkList(&state.string_arena, EMPTY_STRING);
-
-  state.views.capacity = 32;
-  arenaInit(&state.views.arena);
-  state.views.nodes = arenaAllocArray(&state.views.arena, Nodes, state.views.capacity);
-  state.tree = cTreeCreate();
-  state.views.nodes[0].capacity = 1;
-  state.views.nodes[0].length = 1;
-  state.views.nodes[0].nodes = state.tree.nodes;// only works because it's a single root node. would have to alloc otherwise
-
-  CNode* fn_node = addNode(&state.tree, NodeTypeFunction, state.tree.nodes);
-  state.function_node = fn_node;
-  state.selected_node = fn_node;
+  state->cmd_palette_search_input = allocStringChunkList(&state->string_arena, EMPTY_STRING);
+
+  state->views.capacity = VIEWS_INITIAL_CAPACITY;
+  arenaInit(&state->views.arena);
+  state->views.items = arenaAllocArray(&state->views.arena, View, state->views.capacity);
+  MemoryZero(state->views.items, state->views.capacity * sizeof(View));
+  state->tree = cTreeCreate();
+  state->layout = layoutCreate();
+  state->journal = journalCreate(JOURNAL_DEFAULT_MAX_BYTES);
+  state->clip = clipCreate();
+  state->views.length = 1;
+  state->views.items[0].root = state->tree.root;
+  state->views.items[0].cache = viewCacheCreate();
+
+  NodeHandle fn_handle = addNode(&state->tree, NodeTypeFunction, state->tree.root);
+  state->function_node = fn_handle;
+  state->selected_node = fn_handle;
+  CNode* fn_node = nodeFromHandle(&state->tree, fn_handle);
   String main_fn_name = {
     .bytes = "main",
     .length = 4,
     .capacity = 5,
   };
-  fn_node->function.name = allocStringChunkList(&state.string_arena, main_fn_name);
-  fn_node->function.return_type = allocStringChunkList(&state.string_arena, DEFAULT_RETURN_TYPE);
+  CFnDetails* fn_details = nodeFunction(&state->tree, fn_node);
+  fn_details->name = allocStringChunkList(&state->string_arena, main_fn_name);
+  fn_details->return_type = allocStringChunkList(&state->string_arena, DEFAULT_RETURN_TYPE);
 
-  CNode* ret_node = addNode(&state.tree, NodeTypeReturn, fn_node);
+  NodeHandle ret_handle = addNode(&state->tree, NodeTypeReturn, fn_handle);
 
-  CNode* ret_literal_node = addNode(&state.tree, NodeTypeNumericLiteral, ret_node);
-  ret_literal_node->numeric_literal.bytes = "0";
-  ret_literal_node->numeric_literal.length = 1;
-  ret_literal_node->numeric_literal.capacity = 2;
+  CNode* ret_literal_node = nodeFromHandle(&state->tree, addNode(&state->tree, NodeTypeNumericLiteral, ret_handle));
+  String* ret_literal = nodeNumericLiteral(&state->tree, ret_literal_node);
+  ret_literal->bytes = "0";
+  ret_literal->length = 1;
+  ret_literal->capacity = 2;
+}
+
+// gives back everything editorInit and the session since took
+fn void editorRelease(State* state) {
+  for (u32 v = 0; v < state->views.capacity; v++) {
+    if (state->views.items[v].cache.arena.memory != NULL) { // closed views keep theirs too
+      viewCacheRelease(&state->views.items[v].cache);
+    }
+  }
+  arenaFree(&state->views.arena);
+  layoutRelease(&state->layout);
+  journalRelease(&state->journal, &state->tree, &state->string_arena);
+  clipRelease(&state->clip);
+  cTreeRelease(&state->tree);
+  arenaFree(&state->string_arena.a);
+  arenaFree(&state->permanent_arena);
+}
+
+// render_test.c includes this file to drive updateAndRender without a terminal
+#ifndef TREE_EDITOR_NO_MAIN
+i32 main(i32 argc, ptr argv[]) {
+  osInit();
+  ThreadContext tctx = {0};
+  tctxInit(&tctx);
+  State state;
+  editorInit(&state);
 
   // ui loop (read input, simulate next frame, render)
   infiniteUILoop(
@@ -791,5 +743,7 @@ i32 main(i32 argc, ptr argv[]) {
     updateAndRender
   );
 
+  editorRelease(&state);
   return 0;
 }
+#endif
@@ -0,0 +1,73 @@
+#ifndef TREE_STORE_H
+#define TREE_STORE_H
+
+#include "base/all.h"
+#include "c_tree.h"
+
+// a persistent (path-copying) mirror of a CTree. StoreNodes are immutable once written
+// and only hold links downwards, so a version is just a root StoreRef: committing an
+// edit writes new copies of the edited node and its ancestors and shares everything
+// else with the previous version. taking a snapshot is O(1) and a snapshot stays valid
+// no matter what the writer does afterwards.
+//
+// a node's text is copied into the store when the node is written, so readers never
+// touch the CTree's payload tables, which the writer edits in place and recycles.
+// experimental: only the tree_snapshot bench builds one so far. nothing in the editor reads
+// snapshots yet, and committing every edit to a store nobody reclaims would only grow it.
+#define TREE_STORE_MAX_BYTES GB(8llu)
+#define TREE_STORE_INITIAL_CAPACITY (1024)
+#define STORE_REF_NIL (0)
+
+///// TYPES
+typedef u32 StoreRef; // index into TreeStore.nodes
+
+typedef struct StoreNode {
+  u8 type; // NodeType
+  u8 text_count;
+  u32 id;
+  u32 children; // index into TreeStore.child_refs of this node's first child
+  u32 child_count;
+  // a function's name, return type, then each arg's type and name. a literal's digits
+  String* texts;
+} StoreNode;
+
+typedef struct TreeStore {
+  // append-only: written by one thread, readable from any thread holding a snapshot
+  StoreNode* nodes; // node 0 is a zeroed nil node
+  u32 node_count;
+  u32 node_capacity;
+  Arena node_arena;
+  StoreRef* child_refs;
+  u64 child_ref_count;
+  u64 child_ref_capacity;
+  Arena child_ref_arena;
+  Arena text_arena; // StoreNode.texts and their bytes
+
+  // writer-only: where each id lives in the latest version
+  StoreRef* ref_by_id;
+  u32 id_capacity;
+  Arena id_arena;
+  NodeHandle* pending; // scratch for storeWriteNode: nodes waiting on their children
+  u32 pending_capacity;
+  Arena pending_arena;
+
+  Mutex mutex; // guards `root`/`version` so readers never see a half-published version
+  StoreRef root;
+  u64 version;
+} TreeStore;
+
+typedef struct TreeSnapshot {
+  StoreRef root;
+  u64 version;
+} TreeSnapshot;
+
+///// Functions()
+fn TreeStore treeStoreCreate(CTree* tree);
+fn void treeStoreRelease(TreeStore* store);
+fn void treeStoreCommitNode(TreeStore* store, CTree* tree, NodeHandle handle);
+fn TreeSnapshot treeSnapshotTake(TreeStore* store);
+fn StoreNode* storeNode(TreeStore* store, StoreRef ref);
+fn StoreRef* storeChildren(TreeStore* store, StoreNode* node);
+fn u64 treeStoreBytesUsed(TreeStore* store);
+
+#endif //TREE_STORE_H
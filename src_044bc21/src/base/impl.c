@@ -0,0 +1,12 @@
+#ifndef BASE_IMPL_C
+#define BASE_IMPL_C
+
+#include "math.c"
+#include "os.c"
+#include "memory.c"
+#include "serialize.c"
+#include "string.c"
+#include "tctx.c"
+#include "thread.c"
+
+#endif // BASE_IMPL_C
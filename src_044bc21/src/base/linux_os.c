@@ -0,0 +1,217 @@
+#include <sys/mman.h>
+#define _POSIX_C_SOURCE 200809L
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include "all.h"
+
+global pthread_barrier_t linux_thread_barrier;
+
+fn Barrier osBarrierAlloc(u64 count) {
+  pthread_barrier_init(&linux_thread_barrier, NULL, count);
+  Barrier result = {(u64)&linux_thread_barrier};
+  return result;
+}
+
+fn void osBarrierRelease(Barrier barrier) {
+  pthread_barrier_t* addr = (pthread_barrier_t*)barrier.a[0];
+  pthread_barrier_destroy(addr);
+}
+
+fn void osBarrierWait(Barrier barrier) {
+  pthread_barrier_t* addr = (pthread_barrier_t*)barrier.a[0];
+  pthread_barrier_wait(addr);
+}
+
+// Time
+fn u64 osTimeMicrosecondsNow() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((u64)ts.tv_sec * 1000000) + ((u64)ts.tv_nsec / 1000);
+}
+
+#define MICROSECONDS_PER_SECOND 1000000
+#define NANOSECONDS_PER_MICROSECOND 1000
+fn void osSleepMicroseconds(u32 t) {
+  struct timespec ts = { t / MICROSECONDS_PER_SECOND, (t % MICROSECONDS_PER_SECOND)*NANOSECONDS_PER_MICROSECOND };
+  nanosleep(&ts, NULL);
+}
+
+// Events
+fn void osEventLoopRelease(OsEventLoop* loop) {
+  if (loop->epoll != -1) close(loop->epoll);
+  if (loop->signal != -1) close(loop->signal);
+  if (loop->timer != -1) close(loop->timer);
+  loop->epoll = -1;
+  loop->signal = -1;
+  loop->timer = -1;
+  loop->watching_output = false;
+  sigset_t mask;
+  sigemptyset(&mask);
+  sigaddset(&mask, SIGWINCH);
+  sigprocmask(SIG_UNBLOCK, &mask, NULL);
+}
+
+fn OsEventLoop osEventLoopCreate(void) {
+  OsEventLoop result = { .epoll = -1, .signal = -1, .timer = -1 };
+  // SIGWINCH is blocked so it only shows up as a readable signalfd
+  sigset_t mask;
+  sigemptyset(&mask);
+  sigaddset(&mask, SIGWINCH);
+  sigprocmask(SIG_BLOCK, &mask, NULL);
+  result.signal = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+  result.timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  result.epoll = epoll_create1(EPOLL_CLOEXEC);
+
+  i32 fds[3] = { STDIN_FILENO, result.signal, result.timer };
+  u32 events[3] = { OS_EVENT_INPUT, OS_EVENT_RESIZE, OS_EVENT_TIMER };
+  bool ok = result.signal != -1 && result.timer != -1 && result.epoll != -1;
+  for (u32 i = 0; ok && i < 3; i++) {
+    struct epoll_event event = { .events = EPOLLIN, .data.u32 = events[i] };
+    // fails when stdin can't be waited on, e.g. a regular file
+    ok = epoll_ctl(result.epoll, EPOLL_CTL_ADD, fds[i], &event) == 0;
+  }
+  if (!ok) {
+    osEventLoopRelease(&result);
+  }
+  return result;
+}
+
+fn void osEventWatchOutput(OsEventLoop* loop, bool watch) {
+  if (watch == loop->watching_output) return;
+  struct epoll_event event = { .events = EPOLLOUT, .data.u32 = OS_EVENT_OUTPUT };
+  // fails when stdout can't be waited on, e.g. a regular file, which never fills up anyway
+  if (epoll_ctl(loop->epoll, watch ? EPOLL_CTL_ADD : EPOLL_CTL_DEL, STDOUT_FILENO, &event) == 0) {
+    loop->watching_output = watch;
+  }
+}
+
+fn u32 osEventWait(OsEventLoop* loop, u64 timeout_us) {
+  // a one-shot timer, or a disarmed one when waiting forever
+  struct itimerspec timer = {0};
+  timer.it_value.tv_sec = timeout_us / MICROSECONDS_PER_SECOND;
+  timer.it_value.tv_nsec = (timeout_us % MICROSECONDS_PER_SECOND) * NANOSECONDS_PER_MICROSECOND;
+  timerfd_settime(loop->timer, 0, &timer, NULL);
+
+  u32 result = 0;
+  struct epoll_event ready[4];
+  i32 count = epoll_wait(loop->epoll, ready, 4, -1);
+  for (i32 i = 0; i < count; i++) {
+    result |= ready[i].data.u32;
+  }
+  // drain what woke us, stdin is left for osReadConsoleInput
+  if (result & OS_EVENT_RESIZE) {
+    struct signalfd_siginfo info;
+    while (read(loop->signal, &info, sizeof(info)) == sizeof(info)) {}
+  }
+  if (result & OS_EVENT_TIMER) {
+    u64 expirations;
+    read(loop->timer, &expirations, sizeof(expirations));
+  }
+  return result;
+}
+
+// Files
+fn bool osFileExists(String filename) {
+  bool result = access((str)filename.bytes, F_OK) == 0;
+  return result;
+}
+
+fn String osFileRead(Arena* arena, ptr filepath) {
+  struct stat st;
+  stat(filepath, &st);
+  String result = { st.st_size, st.st_size, 0 };
+  result.bytes = arenaAlloc(arena, st.st_size);
+
+  size_t handle = open(filepath, O_RDWR, S_IRUSR | S_IRGRP | S_IROTH);
+  read(handle, result.bytes, st.st_size);
+  close(handle);
+
+  return result;
+}
+
+fn bool osFileCreate(String filename) {
+  /*
+  M_Scratch scratch = scratch_get();
+  string nt = str_copy(&scratch.arena, filename);
+  bool result = true;
+  size_t handle = open((const char*) nt.str, O_RDWR | O_CREAT, S_IRUSR | S_IRGRP | S_IROTH);
+  if (handle == -1) {
+      result = false;
+  }
+  scratch_return(&scratch);
+  close(handle);
+  return true;
+  */
+  bool result = true;
+  size_t handle = open((str)filename.bytes, O_RDWR | O_CREAT, S_IRUSR | S_IRGRP | S_IROTH);
+  if (handle == -1) {
+    result = false;
+  }
+  if (close(handle) == -1) {
+    result = false;
+  }
+  return result;
+}
+
+fn bool osFileCreateWrite(String filename, String data) {
+  /*
+  M_Scratch scratch = scratch_get();
+  string nt = str_copy(&scratch.arena, filename);
+  b32 result = true;
+  size_t handle =
+    open((const char*) nt.str, O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IRGRP | S_IROTH);
+  if (handle == -1) result = false;
+  write(handle, data.str, data.size);
+  close(handle);
+  scratch_return(&scratch);
+  return result;
+  */
+  bool result = true;
+  size_t handle = open(
+    (str)filename.bytes,
+    O_RDWR | O_CREAT | O_TRUNC,
+    S_IRUSR | S_IRGRP | S_IROTH
+  );
+  if (handle == -1) result = false;
+  write(handle, data.bytes, data.length);
+  close(handle);
+  return result;
+}
+
+fn bool osFileWrite(String filename, String data) {
+  /*
+    M_Scratch scratch = scratch_get();
+    string nt = str_copy(&scratch.arena, filename);
+    b32 result = true;
+    size_t handle =
+        open((const char*) nt.str, O_RDWR | O_TRUNC, S_IRUSR | S_IRGRP | S_IROTH);
+    if (handle == -1) result = false;
+    write(handle, data.str, data.size);
+    close(handle);
+  */
+  bool result = true;
+  size_t handle = open((str) filename.bytes, O_RDWR | O_TRUNC, S_IRUSR | S_IRGRP | S_IROTH);
+  if (handle == -1) result = false;
+  write(handle, data.bytes, data.length);
+  close(handle);
+  return result;
+}
+
+
+// Misc
+fn void osDebugPrint(bool debug_mode, const char * format, ... ) {
+  if (debug_mode) {
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+  }
+}
@@ -0,0 +1,81 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include "base/all.h"
+#include "string_chunk.h"
+#include "c_tree.h"
+
+// undo/redo as a log of small invertible ops. entries name nodes by id, so they survive
+// compaction, and every undo/redo is O(1) apart from re-typing a whole replaced string.
+// deleted subtrees aren't freed right away: they're unlinked and kept alive (see
+// unlinkNode) until the entry that could bring them back falls out of the history.
+//
+// entries [first, done) can be undone, [done, length) can be redone. text for the
+// string ops lives in `text`, which grows and shrinks in step with `entries`.
+#define JOURNAL_DEFAULT_MAX_BYTES MB(8)
+#define JOURNAL_INITIAL_CAPACITY (256)
+
+///// TYPES
+typedef enum JournalOp {
+  JournalOpInsertNode,
+  JournalOpDeleteNode,
+  JournalOpChangeType,
+  JournalOpAppendText,  // a run of typed characters
+  JournalOpDeleteText,  // a run of backspaces, text holds the deleted bytes last-first
+  JournalOpReplaceText, // text holds the old string followed by the new one
+  JournalOp_Count
+} JournalOp;
+
+typedef enum TextField {
+  TextFieldFunctionName,
+  TextFieldFunctionReturnType,
+  TextField_Count
+} TextField;
+
+typedef struct JournalEntry {
+  u8 op; // JournalOp
+  u8 field; // TextField, for the text ops
+  u8 old_type; // NodeType, for JournalOpChangeType
+  u8 new_type;
+  u32 node_id;
+  u32 parent_id; // where an inserted/deleted node sits: after prev_id, or first if that's 0
+  u32 prev_id;
+  u32 node_count; // nodes in the inserted/deleted subtree, so they count against the memory cap
+  u32 text_length;
+  u32 replacement_length;
+  u64 text; // absolute offset into the journal's text stream
+} JournalEntry;
+
+typedef struct Journal {
+  u64 max_bytes;
+  u64 bytes_used; // entries, text, and the nodes that deleted subtrees are keeping alive
+  u32 first;
+  u32 done;
+  u32 length;
+  u32 capacity;
+  bool coalesce; // whether the next character edit may extend the newest entry
+  JournalEntry* entries;
+  Arena entry_arena;
+  u64 text_base; // absolute offset of text[0]
+  u64 text_length;
+  u64 text_capacity;
+  u8* text;
+  Arena text_arena;
+} Journal;
+
+///// Functions()
+fn Journal journalCreate(u64 max_bytes);
+fn void journalRelease(Journal* journal, CTree* tree, StringArena* strings);
+fn NodeHandle journalInsertNode(Journal* journal, CTree* tree, StringArena* strings, NodeType type, NodeHandle parent, NodeHandle prev);
+fn NodeHandle journalPaste(Journal* journal, CTree* tree, StringArena* strings, CTreeClip* clip, NodeHandle parent, NodeHandle prev);
+fn void journalDeleteNode(Journal* journal, CTree* tree, StringArena* strings, NodeHandle node);
+fn void journalChangeType(Journal* journal, CTree* tree, StringArena* strings, NodeHandle node, NodeType type);
+fn void journalAppendText(Journal* journal, CTree* tree, StringArena* strings, NodeHandle node, TextField field, String string);
+fn void journalDeleteText(Journal* journal, CTree* tree, StringArena* strings, NodeHandle node, TextField field);
+fn void journalReplaceText(Journal* journal, CTree* tree, StringArena* strings, NodeHandle node, TextField field, String string);
+fn NodeHandle journalUndo(Journal* journal, CTree* tree, StringArena* strings);
+fn NodeHandle journalRedo(Journal* journal, CTree* tree, StringArena* strings);
+fn void journalBreakRun(Journal* journal);
+fn StringChunkList* textFieldList(CTree* tree, CNode* node, TextField field);
+
+#endif //JOURNAL_H
@@ -0,0 +1,1589 @@
+#include "../base/all.h"
+#include "../string_chunk.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#if ARCH_X64
+#include <immintrin.h>
+#endif
+
+#define UTF8_MAX_WIDTH 4
+#define PIXEL_BOLD (1 << 0)
+#define PIXEL_UNDERLINE (1 << 1)
+#define ANSI_HP_RED (196)
+#define ANSI_MP_BLUE (33)
+#define ANSI_LIGHT_GREEN (82)
+#define ANSI_MID_GREEN (70)
+#define ANSI_DARK_GREEN (35)
+#define ANSI_BLACK (16)
+#define ANSI_WHITE (15)
+#define ANSI_BROWN (130)
+#define ANSI_DULL_RED (1)
+#define ANSI_HIGHLIGHT_RED (9)
+#define ANSI_DULL_GREEN (2)
+#define ANSI_HIGHLIGHT_GREEN (10)
+#define ANSI_DULL_YELLOW (3)
+#define ANSI_HIGHLIGHT_YELLOW (11)
+#define ANSI_DULL_BLUE (4)
+#define ANSI_HIGHLIGHT_BLUE (12)
+#define ANSI_DULL_GRAY (7)
+#define ANSI_HIGHLIGHT_GRAY (16)
+#define MAX_COMMAND_PALETTE_COMMANDS (1000)
+#define ANSI_OUTPUT_BYTES MB(1)
+#define ANSI_MAX_CELL_BYTES (64) // worst case for one cell: a cursor move, a full SGR and a 4-byte character
+#define ANSI_SYNC_BEGIN "\033[?2026h" // the terminal holds the screen until ANSI_SYNC_END, so a frame
+#define ANSI_SYNC_END "\033[?2026l" // that arrives in pieces never shows half drawn. others ignore it
+#define TUI_OUTPUT_RING_BYTES MB(4) // a power of two
+#define TUI_PIPELINE_SLOTS (4) // the frame on screen, one being written, one waiting and one being drawn
+#define FRAME_SCROLL_MAX_LINES (64) // the furthest a block of rows is looked for
+#define FRAME_SCROLL_MIN_ROWS (2) // rows a scroll has to save before it's worth its escape codes
+#define ANSI_MOVE_IMPOSSIBLE (1u << 30) // the cost of a cursor move that can't be made
+#define TUI_LANES_MIN_CELLS (20000) // smaller frames encode faster than the other lanes wake up
+
+///// GLOBALS
+global const u8 ANSI_DIGIT_PAIRS[] = "00010203040506070809101112131415161718192021222324252627282930313233343536373839404142434445464748495051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+// ";38;5;N" and ";48;5;N" for every 256-color index, built once by ansiTablesInit
+global u8 ANSI_FOREGROUND_PARAMS[256][12];
+global u8 ANSI_FOREGROUND_PARAMS_LENGTH[256];
+global u8 ANSI_BACKGROUND_PARAMS[256][12];
+global u8 ANSI_BACKGROUND_PARAMS_LENGTH[256];
+global bool ANSI_TABLES_READY = false;
+// infiniteUILoop waits for events where it can (linux), this forces the old fixed-rate polling
+global bool TUI_FORCE_POLLING = false;
+// infiniteUILoop diffs, encodes and writes frames on a second thread, see TuiPipeline
+global bool TUI_PIPELINED = false;
+// more than 1: frames of TUI_LANES_MIN_CELLS or more are diffed and encoded on that many threads
+global u32 TUI_ENCODE_LANES = 0;
+
+///// TYPES
+// a cell is one aligned 8 byte word, so comparing two is a single compare
+typedef struct Pixel {
+  u8 foreground;
+  u8 background;
+  u8 attributes; // PIXEL_BOLD, PIXEL_UNDERLINE
+  u8 reserved;
+  u8 bytes[UTF8_MAX_WIDTH];
+} Pixel;
+
+// a run of cells in one row that changed between two frames
+typedef struct PixelSpan {
+  u16 row;
+  u16 start;
+  u16 end; // exclusive
+} PixelSpan;
+
+// every changed cell between two frames, as spans in screen order. `diff_row` compares one
+// row's bytes and is picked once for the CPU: AVX2, SSE2, or a plain loop
+typedef struct FrameDiff {
+  u32 length;
+  u32 capacity;
+  u32 rows_compared; // rows the last frameDiff had to run `diff_row` on
+  PixelSpan* spans;
+  void (*diff_row)(struct FrameDiff* diff, Pixel* old, Pixel* next, u32 width, u16 row);
+} FrameDiff;
+
+// rows top..bottom of the old frame, moved `lines` down (or up, when negative) together. the
+// terminal can do that itself inside a scroll region instead of being sent the rows again
+typedef struct FrameScroll {
+  u16 top;
+  u16 bottom; // inclusive
+  i16 lines; // 0 is no scroll
+} FrameScroll;
+
+// builds the escape codes for a frame in a fixed buffer without going through printf.
+// when the buffer fills up mid-frame, what's there goes to `flush` and encoding carries on
+typedef struct AnsiEncoder {
+  u8* bytes;
+  u64 length;
+  u64 capacity;
+  u64 flushed; // bytes handed to `flush` so far
+  void (*flush)(u8* bytes, u64 length);
+} AnsiEncoder;
+
+// where the cursor is and the style it prints in, going by the escape codes encoded so far
+typedef struct AnsiPen {
+  u16 x; // 1-based
+  u16 y; // 1-based, 0 when the cursor could be anywhere
+  u8 foreground;
+  u8 background;
+  u8 attributes;
+} AnsiPen;
+
+// escape codes on their way to the terminal. writing never blocks: whatever the terminal won't
+// take yet waits here, and printfBufferAndSwap drops frames until it's gone instead of queueing
+// them. head and tail only grow, the byte for either is at `& (capacity - 1)`
+typedef struct TuiWriter {
+  u8* bytes;
+  u64 capacity;
+  u64 head; // bytes the terminal has taken so far
+  u64 tail; // bytes pushed so far, head == tail is empty
+  u64 dropped_frames;
+} TuiWriter;
+
+// bytes of frame memory each stage of the last frame touched
+typedef struct TuiFrameStats {
+  u64 cleared_bytes;
+  u64 hashed_bytes;
+  u64 diffed_bytes; // both buffers
+  u64 encoded_bytes; // escape codes handed to the terminal
+} TuiFrameStats;
+
+// one lane's rows of a frame: its own diff, and its own escape codes
+typedef struct TuiBand {
+  FrameDiff diff;
+  AnsiEncoder ansi; // big enough for the whole band, never flushed
+  AnsiPen pen; // where the band leaves the cursor
+  u64 lane_broadcast; // LaneCtx.broadcast_memory
+} TuiBand;
+
+typedef struct TuiLaneWorker {
+  struct TuiLanes* lanes;
+  LaneCtx ctx;
+} TuiLaneWorker;
+
+// printfBufferAndSwap split over lanes: each one diffs and encodes a band of rows. a band starts
+// from a style reset and moves the cursor to its first cell, so they go out back to back with
+// no fixing up. lane 0 is whichever thread calls printfBufferAndSwap, the others wait in between
+// frames. only one at a time, osBarrierAlloc hands out the same barrier every time
+typedef struct TuiLanes {
+  u32 count;
+  TuiBand* bands;
+  TuiLaneWorker* workers;
+  Thread* threads; // lanes 1..count-1
+  struct TuiState* tui; // the frame being encoded
+  bool whole; // a full redraw, no diff
+  bool quit;
+} TuiLanes;
+
+typedef struct TuiState {
+  bool redraw;
+  AnsiEncoder ansi;
+  FrameDiff diff;
+  Pixel* frame_buffer;
+  Pixel* back_buffer;
+  u64* row_hashes; // per row of frame_buffer, filled in by printfBufferAndSwap
+  u64* back_row_hashes; // per row of back_buffer, so unchanged rows skip the diff
+  Dim2 frame_buffer_dimensions; // the screen size each buffer was last drawn at
+  Dim2 back_buffer_dimensions;
+  u64 buffer_len; // how many Pixels
+  TuiFrameStats stats;
+  Pos2 cursor;
+  Pos2 prev_cursor;
+  Dim2 screen_dimensions;
+  Dim2 prev_screen_dimensions;
+  bool frame_dropped; // the terminal hasn't seen the last frame, so the next one goes out even if it's the same
+  TuiLanes* lanes; // NULL encodes on the calling thread alone
+  // updateAndRender sets this to get another frame that many us later even without input,
+  // e.g. to make something disappear. 0 waits for the next input or resize
+  u64 wake_in_us;
+} TuiState;
+
+// a frame buffer, and what tuiClearFrame needs to know about what's in it
+typedef struct TuiPipelineSlot {
+  Pixel* pixels;
+  u64* row_hashes;
+  Dim2 dimensions;
+  bool free;
+} TuiPipelineSlot;
+
+// TUI_PIPELINED: updateAndRender stays on the loop's thread, printfBufferAndSwap runs on a
+// writer thread with its own TuiState, whose back_buffer is what the terminal shows. frames
+// change hands through the slots: the writer takes the newest one, and one that gets replaced
+// before the writer was free for it is skipped. there are enough slots that the loop never waits
+typedef struct TuiPipeline {
+  Mutex mutex;
+  Cond cond; // a frame was published, or it's time to stop
+  TuiPipelineSlot slots[TUI_PIPELINE_SLOTS];
+  i32 drawing; // the loop's slot
+  i32 published; // the slot waiting for the writer, -1 when there's none
+  Dim2 published_dimensions;
+  Pos2 published_cursor;
+  bool published_redraw;
+  bool quit;
+  u64 skipped_frames;
+  TuiState out; // only the writer touches this
+  Thread thread;
+} TuiPipeline;
+
+typedef struct RGB {
+    u8 r;
+    u8 g;
+    u8 b;
+} RGB;
+
+typedef struct CommandPaletteCommand {
+  u32 id;
+  ptr display_name;
+  ptr description;
+  ptr* tags;
+} CommandPaletteCommand;
+
+typedef struct CommandPaletteCommandList {
+  u32 length;
+  CommandPaletteCommand* items;
+} CommandPaletteCommandList;
+
+typedef struct StringSearchScore {
+  bool name_matched;
+  bool description_matched;
+  u16 tag_match_count;
+  u32 score;
+  u32 name_match_start;
+  u32 name_match_len;
+  u32 description_match_start;
+  u32 description_match_len;
+} StringSearchScore;
+
+///// Functions()
+fn u32 rgbToNum(RGB rgb) {
+    return ((rgb.r<<16) | (rgb.g<<8) | rgb.b);
+}
+
+fn u8 rgbToAnsi(RGB color) {
+    u8 r = color.r / (255 / 5);
+    u8 g = color.g / (255 / 5);
+    u8 b = color.b / (255 / 5);
+    return 16 + (36*r) + (6*g) + b;
+}
+
+fn RGB rgbDarken(RGB color, f32 factor) {
+  RGB result = {
+    .r = ((f32)color.r) * factor,
+    .g = ((f32)color.g) * factor,
+    .b = ((f32)color.b) * factor,
+  };
+  return result;
+}
+
+/*
+fn RGB ansiToRGB(u8 ansi) {
+  ansi -= 16;
+  u8 b = ansi % 51;
+  ansi -= ()
+  u8 g = 
+}
+*/
+
+fn bool rgbEq(RGB a, RGB b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+
+fn u64 pixelWord(Pixel pixel) {
+  u64 word;
+  MemoryCopy(&word, &pixel, sizeof(Pixel));
+  return word;
+}
+
+fn bool isPixelEq(Pixel a, Pixel b) {
+  return pixelWord(a) == pixelWord(b);
+}
+
+// four interleaved multiply-xor lanes, folded together at the end. every step is a
+// bijection, so two rows that differ in a single cell always hash differently
+fn u64 pixelRowHash(Pixel* row, u32 width) {
+  u64 k = 0x9e3779b97f4a7c15ull;
+  u64 h0 = 1, h1 = 2, h2 = 3, h3 = 4;
+  u32 x = 0;
+  for (; x + 4 <= width; x += 4) {
+    h0 = (h0 ^ pixelWord(row[x])) * k;
+    h1 = (h1 ^ pixelWord(row[x+1])) * k;
+    h2 = (h2 ^ pixelWord(row[x+2])) * k;
+    h3 = (h3 ^ pixelWord(row[x+3])) * k;
+  }
+  for (; x < width; x++) {
+    h0 = (h0 ^ pixelWord(row[x])) * k;
+  }
+  return ((((h0 * k) ^ h1) * k ^ h2) * k ^ h3) * k;
+}
+
+// pixelRowHash of a row of zeroed pixels
+fn u64 pixelBlankRowHash(u32 width) {
+  u64 k = 0x9e3779b97f4a7c15ull;
+  u64 h0 = 1, h1 = 2, h2 = 3, h3 = 4;
+  u32 x = 0;
+  for (; x + 4 <= width; x += 4) {
+    h0 *= k;
+    h1 *= k;
+    h2 *= k;
+    h3 *= k;
+  }
+  for (; x < width; x++) {
+    h0 *= k;
+  }
+  return ((((h0 * k) ^ h1) * k ^ h2) * k ^ h3) * k;
+}
+
+fn u32 lowestSetBit(u32 mask) {
+  assert(mask != 0);
+#if COMPILER_CL
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return index;
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+
+// marks pixels [first, end), joining the previous span when they touch
+fn void frameDiffMarkRun(FrameDiff* diff, u16 row, u32 first, u32 end) {
+  if (diff->length > 0) {
+    PixelSpan* last = &diff->spans[diff->length - 1];
+    if (last->row == row && last->end == first) {
+      last->end = end;
+      return;
+    }
+  }
+  assert(diff->length < diff->capacity);
+  diff->spans[diff->length++] = (PixelSpan){ .row = row, .start = first, .end = end };
+}
+
+// `bits` has one bit per pixel of a block starting at pixel `first`, marks each run of them
+fn void frameDiffMarkBits(FrameDiff* diff, u16 row, u32 first, u32 bits) {
+  while (bits != 0) {
+    u32 start = lowestSetBit(bits);
+    u32 run = lowestSetBit(~(bits >> start));
+    frameDiffMarkRun(diff, row, first + start, first + start + run);
+    bits &= ~0u << (start + run);
+  }
+}
+
+// compares the pixels from `x` to the end of the row
+fn void frameDiffRowTail(FrameDiff* diff, Pixel* old, Pixel* next, u32 x, u32 width, u16 row) {
+  for (; x < width; x++) {
+    if (!isPixelEq(old[x], next[x])) {
+      frameDiffMarkRun(diff, row, x, x + 1);
+    }
+  }
+}
+
+fn void frameDiffRowScalar(FrameDiff* diff, Pixel* old, Pixel* next, u32 width, u16 row) {
+  frameDiffRowTail(diff, old, next, 0, width, row);
+}
+
+#if ARCH_X64
+// 8 pixels per step. SSE2 only compares 32 bit lanes, a pixel is two of them
+fn void frameDiffRowSse2(FrameDiff* diff, Pixel* old, Pixel* next, u32 width, u16 row) {
+  u32 x = 0;
+  for (; x + 8 <= width; x += 8) {
+    u32 equal = 0;
+    for (u32 i = 0; i < 4; i++) {
+      __m128i a = _mm_loadu_si128((__m128i*)(old + x + i*2));
+      __m128i b = _mm_loadu_si128((__m128i*)(next + x + i*2));
+      equal |= (u32)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b))) << (i*4);
+    }
+    u32 lanes = ~equal & 0xffff;
+    if (lanes != 0) {
+      // a pixel differs if either of its lanes does, then squeeze every other bit together
+      u32 bits = (lanes | lanes >> 1) & 0x5555;
+      bits = (bits | bits >> 1) & 0x3333;
+      bits = (bits | bits >> 2) & 0x0f0f;
+      bits = (bits | bits >> 4) & 0x00ff;
+      frameDiffMarkBits(diff, row, x, bits);
+    }
+  }
+  frameDiffRowTail(diff, old, next, x, width, row);
+}
+#endif
+
+#if ARCH_X64 && (COMPILER_GCC || COMPILER_CLANG)
+// 16 pixels per step, one 64 bit lane per pixel
+__attribute__((target("avx2")))
+fn void frameDiffRowAvx2(FrameDiff* diff, Pixel* old, Pixel* next, u32 width, u16 row) {
+  u32 x = 0;
+  for (; x + 16 <= width; x += 16) {
+    u32 equal = 0;
+    for (u32 i = 0; i < 4; i++) {
+      __m256i a = _mm256_loadu_si256((__m256i*)(old + x + i*4));
+      __m256i b = _mm256_loadu_si256((__m256i*)(next + x + i*4));
+      equal |= (u32)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(a, b))) << (i*4);
+    }
+    u32 bits = ~equal & 0xffff;
+    if (bits != 0) {
+      frameDiffMarkBits(diff, row, x, bits);
+    }
+  }
+  frameDiffRowTail(diff, old, next, x, width, row);
+}
+#endif
+
+fn FrameDiff frameDiffCreate(Arena* a, u64 pixel_count) {
+  FrameDiff result = {
+    .capacity = pixel_count, // spans never share a cell, so there can't be more than there are cells
+    .spans = arenaAllocArray(a, PixelSpan, pixel_count),
+    .diff_row = frameDiffRowScalar,
+  };
+#if ARCH_X64
+  result.diff_row = frameDiffRowSse2;
+#endif
+#if ARCH_X64 && (COMPILER_GCC || COMPILER_CLANG)
+  if (__builtin_cpu_supports("avx2")) {
+    result.diff_row = frameDiffRowAvx2;
+  }
+#endif
+  return result;
+}
+
+fn void frameHashRows(u64* hashes, Pixel* pixels, Dim2 sd) {
+  for (u16 row = 0; row < sd.height; row++) {
+    hashes[row] = pixelRowHash(pixels + row * sd.width, sd.width);
+  }
+}
+
+// finds the shift of a band of rows that turns the most changed rows of the old frame into
+// rows of the next one, e.g. everything below a line that was inserted. only row hashes are
+// compared, and a shift has to save FRAME_SCROLL_MIN_ROWS rows of text to be picked
+fn FrameScroll frameFindScroll(u64* old_hashes, u64* next_hashes, Dim2 sd) {
+  FrameScroll result = {0};
+  u16 top = 0;
+  u16 bottom = sd.height;
+  while (top < sd.height && old_hashes[top] == next_hashes[top]) top++;
+  while (bottom > top && old_hashes[bottom-1] == next_hashes[bottom-1]) bottom--;
+  if (bottom - top < 2) return result;
+  bottom -= 1;
+
+  u64 blank = pixelBlankRowHash(sd.width);
+  i32 best = FRAME_SCROLL_MIN_ROWS - 1;
+  i32 max_lines = Min(FRAME_SCROLL_MAX_LINES, bottom - top);
+  for (i32 lines = -max_lines; lines <= max_lines; lines++) {
+    if (lines == 0) continue;
+    // rows the scroll gets right that were wrong, minus rows it breaks that were right
+    i32 saved = 0;
+    for (i32 row = top; row <= bottom; row++) {
+      i32 from = row - lines;
+      u64 moved = from >= top && from <= bottom ? old_hashes[from] : blank;
+      if (next_hashes[row] == blank && moved == blank) continue; // nothing to send either way
+      saved += (moved == next_hashes[row]) - (old_hashes[row] == next_hashes[row]);
+    }
+    if (saved > best) {
+      best = saved;
+      result = (FrameScroll){ .top = top, .bottom = bottom, .lines = lines };
+    }
+  }
+  return result;
+}
+
+// does to the old frame (and its row hashes) what the scroll does to the terminal's screen
+fn void frameApplyScroll(Pixel* pixels, u64* hashes, Dim2 sd, FrameScroll scroll) {
+  u32 count = abs(scroll.lines);
+  u32 kept = scroll.bottom - scroll.top + 1 - count;
+  u32 from = scroll.lines > 0 ? scroll.top : scroll.top + count;
+  u32 to = scroll.lines > 0 ? scroll.top + count : scroll.top;
+  u32 vacated = scroll.lines > 0 ? scroll.top : scroll.top + kept;
+  memmove(pixels + to * sd.width, pixels + from * sd.width, (u64)kept * sd.width * sizeof(Pixel));
+  memmove(hashes + to, hashes + from, kept * sizeof(u64));
+  MemoryZero(pixels + vacated * sd.width, (u64)count * sd.width * sizeof(Pixel));
+  u64 blank = pixelBlankRowHash(sd.width);
+  for (u32 row = vacated; row < vacated + count; row++) {
+    hashes[row] = blank;
+  }
+}
+
+// compares just the rows of first_row..end_row whose hashes differ, both sets already filled in
+fn void frameDiffHashed(FrameDiff* diff, Pixel* old, Pixel* next, Dim2 sd, u64* old_hashes, u64* next_hashes, u16 first_row, u16 end_row) {
+  diff->length = 0;
+  diff->rows_compared = 0;
+  for (u16 row = first_row; row < end_row; row++) {
+    if (next_hashes[row] == old_hashes[row]) continue;
+    u32 offset = row * sd.width;
+    diff->diff_row(diff, old + offset, next + offset, sd.width, row);
+    diff->rows_compared += 1;
+  }
+}
+
+// one pass over both frames, leaving the spans that differ in `diff`. given row hashes,
+// fills in `next_hashes` and only compares the rows whose hash moved away from `old_hashes`
+fn void frameDiff(FrameDiff* diff, Pixel* old, Pixel* next, Dim2 sd, u64* old_hashes, u64* next_hashes) {
+  diff->length = 0;
+  diff->rows_compared = 0;
+  for (u16 row = 0; row < sd.height; row++) {
+    u32 offset = row * sd.width;
+    if (next_hashes != NULL) {
+      next_hashes[row] = pixelRowHash(next + offset, sd.width);
+      if (next_hashes[row] == old_hashes[row]) continue;
+    }
+    diff->diff_row(diff, old + offset, next + offset, sd.width, row);
+    diff->rows_compared += 1;
+  }
+}
+
+fn TuiWriter tuiWriterCreate(Arena* a, u64 capacity) {
+  assert((capacity & (capacity - 1)) == 0 && "TuiWriter capacity has to be a power of two");
+  TuiWriter result = {
+    .bytes = arenaAlloc(a, capacity),
+    .capacity = capacity,
+  };
+  return result;
+}
+
+// hands the terminal as much as it will take right now, returns how much is still waiting
+fn u64 tuiWriterDrain(TuiWriter* w) {
+  while (w->head != w->tail) {
+    u64 at = w->head & (w->capacity - 1);
+    i64 written = osWriteToTerminal((ptr)w->bytes + at, Min(w->tail - w->head, w->capacity - at));
+    if (written <= 0) {
+      if (written < 0) w->head = w->tail; // the terminal is gone, nobody is waiting for these
+      break;
+    }
+    w->head += written;
+  }
+  return w->tail - w->head;
+}
+
+// only ever waits on the terminal when one frame is bigger than the whole ring
+fn void tuiWriterPush(TuiWriter* w, u8* bytes, u64 length) {
+  while (length > 0) {
+    if (w->tail - w->head == w->capacity && tuiWriterDrain(w) == w->capacity) {
+      osWaitForTerminalWritable(100000);
+      continue;
+    }
+    u64 at = w->tail & (w->capacity - 1);
+    u64 chunk = Min(Min(length, w->capacity - (w->tail - w->head)), w->capacity - at);
+    MemoryCopy(w->bytes + at, bytes, chunk);
+    w->tail += chunk;
+    bytes += chunk;
+    length -= chunk;
+  }
+  tuiWriterDrain(w);
+}
+
+// waits for the terminal to take everything, before leaving the alternate screen
+fn void tuiWriterFinish(TuiWriter* w) {
+  while (tuiWriterDrain(w) > 0) {
+    osWaitForTerminalWritable(100000);
+  }
+}
+
+// there's one terminal, infiniteUILoop sets this up
+global TuiWriter TUI_WRITER = {0};
+
+fn void ansiFlushToTerminal(u8* bytes, u64 length) {
+  tuiWriterPush(&TUI_WRITER, bytes, length);
+}
+
+// writes `value` in decimal at `out`, two digits at a time, returns how many bytes it took
+fn u32 ansiFormatU32(u8* out, u32 value) {
+  u8 digits[10];
+  u32 at = sizeof(digits);
+  while (value >= 100) {
+    u32 pair = (value % 100) * 2;
+    value /= 100;
+    digits[--at] = ANSI_DIGIT_PAIRS[pair + 1];
+    digits[--at] = ANSI_DIGIT_PAIRS[pair];
+  }
+  if (value >= 10) {
+    digits[--at] = ANSI_DIGIT_PAIRS[value*2 + 1];
+    digits[--at] = ANSI_DIGIT_PAIRS[value*2];
+  } else {
+    digits[--at] = '0' + value;
+  }
+  u32 length = sizeof(digits) - at;
+  MemoryCopy(out, digits + at, length);
+  return length;
+}
+
+fn void ansiTablesInit() {
+  if (ANSI_TABLES_READY) return;
+  for (u32 color = 0; color < 256; color++) {
+    MemoryCopy(ANSI_FOREGROUND_PARAMS[color], ";38;5;", 6);
+    ANSI_FOREGROUND_PARAMS_LENGTH[color] = 6 + ansiFormatU32(ANSI_FOREGROUND_PARAMS[color] + 6, color);
+    MemoryCopy(ANSI_BACKGROUND_PARAMS[color], ";48;5;", 6);
+    ANSI_BACKGROUND_PARAMS_LENGTH[color] = 6 + ansiFormatU32(ANSI_BACKGROUND_PARAMS[color] + 6, color);
+  }
+  ANSI_TABLES_READY = true;
+}
+
+fn AnsiEncoder ansiEncoderCreate(Arena* a, u64 capacity, void (*flush)(u8* bytes, u64 length)) {
+  assert(capacity >= ANSI_MAX_CELL_BYTES * 2 && "ANSI output buffer is too small to make progress");
+  ansiTablesInit();
+  AnsiEncoder result = {
+    .bytes = arenaAlloc(a, capacity),
+    .capacity = capacity,
+    .flush = flush,
+  };
+  return result;
+}
+
+fn void ansiFlush(AnsiEncoder* enc) {
+  if (enc->length > 0) {
+    enc->flush(enc->bytes, enc->length);
+    enc->flushed += enc->length;
+    enc->length = 0;
+  }
+}
+
+// makes sure the next `size` bytes fit, every writer below assumes they do
+fn void ansiReserve(AnsiEncoder* enc, u64 size) {
+  assert(size <= enc->capacity);
+  if (enc->length + size > enc->capacity) {
+    ansiFlush(enc);
+  }
+}
+
+fn void ansiPutBytes(AnsiEncoder* enc, u8* bytes, u64 length) {
+  MemoryCopy(enc->bytes + enc->length, bytes, length);
+  enc->length += length;
+}
+
+// (x, y) are 1-based, like the terminal's
+fn void ansiMoveCursorTo(AnsiEncoder* enc, u16 x, u16 y) {
+  u8* out = enc->bytes + enc->length;
+  u32 length = 0;
+  out[length++] = '\033';
+  out[length++] = '[';
+  length += ansiFormatU32(out + length, y);
+  out[length++] = ';';
+  length += ansiFormatU32(out + length, x);
+  out[length++] = 'f';
+  enc->length += length;
+}
+
+fn u32 ansiDigitCount(u32 value) {
+  u32 result = 1;
+  while (value >= 10) {
+    value /= 10;
+    result += 1;
+  }
+  return result;
+}
+
+// ESC[nA (up), B (down), C (right) or D (left), n left out when it's 1
+fn u32 ansiRelativeMoveCost(u32 n) {
+  return n == 0 ? 0 : n == 1 ? 3 : 3 + ansiDigitCount(n);
+}
+
+fn void ansiPutRelativeMove(AnsiEncoder* enc, u32 n, u8 direction) {
+  if (n == 0) return;
+  u8* out = enc->bytes + enc->length;
+  u32 length = 0;
+  out[length++] = '\033';
+  out[length++] = '[';
+  if (n > 1) {
+    length += ansiFormatU32(out + length, n);
+  }
+  out[length++] = direction;
+  enc->length += length;
+}
+
+// bytes to print the cells first..end (0-based, exclusive) of `shown` over themselves, or
+// ANSI_MOVE_IMPOSSIBLE if one of them isn't plain ASCII in the pen's style, or a blank the
+// pen's style would color. stops looking once it costs more than `limit`
+fn u32 ansiReprintCost(Pixel* shown, u16 first, u16 end, AnsiPen* pen, u32 limit) {
+  if (shown == NULL || end - first > limit) return ANSI_MOVE_IMPOSSIBLE;
+  bool pen_is_plain = pen->foreground == 0 && pen->background == 0 && pen->attributes == 0;
+  for (u16 x = first; x < end; x++) {
+    Pixel* pixel = &shown[x];
+    bool reprintable = pixel->bytes[0] == 0
+      ? pen_is_plain
+      : pixel->bytes[0] < 0x80 && pixel->bytes[1] == 0
+        && pixel->foreground == pen->foreground
+        && pixel->background == pen->background
+        && pixel->attributes == pen->attributes;
+    if (!reprintable) return ANSI_MOVE_IMPOSSIBLE;
+  }
+  return end - first;
+}
+
+fn void ansiPutReprint(AnsiEncoder* enc, Pixel* shown, u16 first, u16 end) {
+  for (u16 x = first; x < end; x++) {
+    enc->bytes[enc->length++] = shown[x].bytes[0] == 0 ? ' ' : shown[x].bytes[0];
+  }
+}
+
+// moves the pen to (x, y), 1-based, the way that takes the fewest bytes, like ncurses' mvcur:
+// an absolute move, relative moves, a carriage return and line feeds, or printing the cells
+// in between over themselves. `shown` is row y as the terminal shows it right now, NULL
+// when that isn't known
+fn void ansiMoveCursor(AnsiEncoder* enc, AnsiPen* pen, u16 x, u16 y, Pixel* shown) {
+  if (pen->y == y && pen->x == x) return;
+  u32 absolute = 4 + ansiDigitCount(y) + ansiDigitCount(x);
+  u32 direct = ANSI_MOVE_IMPOSSIBLE;
+  u32 from_start = ANSI_MOVE_IMPOSSIBLE;
+  u32 dy = 0, dx = 0;
+  u8 vertical_direction = y > pen->y ? 'B' : 'A';
+  u8 horizontal_direction = x > pen->x ? 'C' : 'D';
+  bool direct_reprints = false;
+  bool start_reprints = false;
+  bool start_line_feeds = false;
+  if (pen->y != 0) {
+    dy = y > pen->y ? y - pen->y : pen->y - y;
+    dx = x > pen->x ? x - pen->x : pen->x - x;
+    // up or down, then right or left from the same column
+    u32 vertical = ansiRelativeMoveCost(dy);
+    u32 horizontal = ansiRelativeMoveCost(dx);
+    u32 reprint = x > pen->x ? ansiReprintCost(shown, pen->x - 1, x - 1, pen, absolute) : ANSI_MOVE_IMPOSSIBLE;
+    direct_reprints = reprint < horizontal;
+    direct = vertical + Min(horizontal, reprint);
+    // a carriage return, down, then right from the first column. a line feed can be two
+    // bytes on the wire, the tty turns it into CR LF unless OPOST is off
+    u32 line_feeds = y >= pen->y ? 2 * dy : ANSI_MOVE_IMPOSSIBLE;
+    start_line_feeds = line_feeds < vertical;
+    horizontal = ansiRelativeMoveCost(x - 1);
+    reprint = ansiReprintCost(shown, 0, x - 1, pen, absolute);
+    start_reprints = reprint < horizontal;
+    from_start = 1 + Min(vertical, line_feeds) + Min(horizontal, reprint);
+  }
+
+  if (absolute <= direct && absolute <= from_start) {
+    ansiMoveCursorTo(enc, x, y);
+  } else if (direct <= from_start) {
+    ansiPutRelativeMove(enc, dy, vertical_direction);
+    if (direct_reprints) {
+      ansiPutReprint(enc, shown, pen->x - 1, x - 1);
+    } else {
+      ansiPutRelativeMove(enc, dx, horizontal_direction);
+    }
+  } else {
+    ansiPutBytes(enc, (u8*)"\r", 1);
+    if (start_line_feeds) {
+      for (u32 i = 0; i < dy; i++) ansiPutBytes(enc, (u8*)"\n", 1);
+    } else {
+      ansiPutRelativeMove(enc, dy, vertical_direction);
+    }
+    if (start_reprints) {
+      ansiPutReprint(enc, shown, 0, x - 1);
+    } else {
+      ansiPutRelativeMove(enc, x - 1, 'C');
+    }
+  }
+  pen->x = x;
+  pen->y = y;
+}
+
+// sets the scroll region to the scroll's rows, scrolls it, and puts the region back. the
+// rows it opens up are blank in the default colors. leaves the cursor at the top left
+fn void ansiScrollRegion(AnsiEncoder* enc, FrameScroll scroll) {
+  u8* out = enc->bytes + enc->length;
+  u32 length = 0;
+  MemoryCopy(out, "\033[0m\033[", 6);
+  length += 6;
+  length += ansiFormatU32(out + length, scroll.top + 1);
+  out[length++] = ';';
+  length += ansiFormatU32(out + length, scroll.bottom + 1);
+  out[length++] = 'r';
+  out[length++] = '\033';
+  out[length++] = '[';
+  length += ansiFormatU32(out + length, abs(scroll.lines));
+  out[length++] = scroll.lines > 0 ? 'T' : 'S'; // scroll down, or up
+  MemoryCopy(out + length, "\033[r", 3);
+  length += 3;
+  enc->length += length;
+}
+
+// always starts from a reset, so a color going back to 0 can't leave the old one behind
+fn void ansiSetStyle(AnsiEncoder* enc, u8 foreground, u8 background, u8 attributes) {
+  u8* out = enc->bytes + enc->length;
+  u32 length = 0;
+  out[length++] = '\033';
+  out[length++] = '[';
+  out[length++] = '0';
+  if (attributes & PIXEL_BOLD) {
+    out[length++] = ';';
+    out[length++] = '1';
+  }
+  if (attributes & PIXEL_UNDERLINE) {
+    out[length++] = ';';
+    out[length++] = '4';
+  }
+  if (background != 0) {
+    MemoryCopy(out + length, ANSI_BACKGROUND_PARAMS[background], 12);
+    length += ANSI_BACKGROUND_PARAMS_LENGTH[background];
+  }
+  if (foreground != 0) {
+    MemoryCopy(out + length, ANSI_FOREGROUND_PARAMS[foreground], 12);
+    length += ANSI_FOREGROUND_PARAMS_LENGTH[foreground];
+  }
+  out[length++] = 'm';
+  enc->length += length;
+}
+
+// the pixel's character, up to its first zero byte
+fn void ansiPutCharacter(AnsiEncoder* enc, Pixel* pixel) {
+  u8* out = enc->bytes + enc->length;
+  MemoryCopy(out, pixel->bytes, UTF8_MAX_WIDTH);
+  u32 length = 1;
+  while (length < UTF8_MAX_WIDTH && pixel->bytes[length] != 0) {
+    length += 1;
+  }
+  enc->length += length;
+}
+
+fn TuiState tuiInit(Arena* a, u64 buffer_len) {
+  TuiState result = {
+    .redraw = false,
+    .ansi = ansiEncoderCreate(a, ANSI_OUTPUT_BYTES, ansiFlushToTerminal),
+    .diff = frameDiffCreate(a, buffer_len),
+    .buffer_len = buffer_len,
+    .back_buffer = arenaAllocArray(a, Pixel, buffer_len), // allocate biggest possible dimensions
+    .frame_buffer = arenaAllocArray(a, Pixel, buffer_len), // allocate biggest possible dimensions
+    // only the screen's height is known later, and a one column terminal has a row per cell
+    .row_hashes = arenaAllocArray(a, u64, buffer_len),
+    .back_row_hashes = arenaAllocArray(a, u64, buffer_len),
+  };
+  MemoryZero(result.back_buffer, buffer_len * sizeof(Pixel));
+  MemoryZero(result.frame_buffer, buffer_len * sizeof(Pixel));
+  return result;
+}
+
+// zeroes what frame_buffer still holds from the last time it was drawn, before drawing the
+// next frame into it. at the same size only the rows that weren't blank need it, which the
+// row hashes already say. after a resize the rows don't line up, so both areas get zeroed
+fn void tuiClearFrame(TuiState* tui) {
+  Dim2 sd = tui->screen_dimensions;
+  Dim2 drawn = tui->frame_buffer_dimensions;
+  if (drawn.width != sd.width || drawn.height != sd.height) {
+    u64 cells = Min(Max((u64)drawn.width * drawn.height, (u64)sd.width * sd.height), tui->buffer_len);
+    MemoryZero(tui->frame_buffer, cells * sizeof(Pixel));
+    tui->stats.cleared_bytes = cells * sizeof(Pixel);
+    return;
+  }
+  u64 blank = pixelBlankRowHash(sd.width);
+  tui->stats.cleared_bytes = 0;
+  for (u16 row = 0; row < sd.height; row++) {
+    if (tui->row_hashes[row] != blank) {
+      MemoryZero(tui->frame_buffer + row * sd.width, sd.width * sizeof(Pixel));
+      tui->row_hashes[row] = blank;
+      tui->stats.cleared_bytes += sd.width * sizeof(Pixel);
+    }
+  }
+}
+
+fn void copyStr(u8* bytes, str cstring) {
+  for (u32 i = 0; i < strlen(cstring); i++) {
+    bytes[i] = cstring[i];
+  }
+}
+
+fn void drawAnsiBox(Pixel* buf, Box box, Dim2 sd, bool bold) {
+  str items[] =   {"┌","─","┐","│","└","┘"};
+  str b_items[] = {"┏","━","┓","┃","┗","┛"};
+  ptr* use = (ptr*)items;
+  if (bold) {
+    use = (ptr*)b_items;
+  }
+  u32 pos = XYToPos(box.x, box.y, sd.width);
+
+  // print the upper box border
+  copyStr(buf[pos].bytes, use[0]);
+  for (i32 i = 0; i < box.width; i++) {
+    copyStr(buf[pos+1+i].bytes, use[1]);
+  }
+  copyStr(buf[pos+1+box.width].bytes, use[2]);
+
+  // start printing the rows
+  for (i32 i = 0; i < box.height; i++) {
+    pos = XYToPos(box.x, (box.y+1+i), sd.width); // move cursor to beginning of the row
+    copyStr(buf[pos].bytes, use[3]);
+    copyStr(buf[pos+1+box.width].bytes, use[3]);
+  }
+
+  // print the bottom box border
+  pos = XYToPos(box.x, (box.y+1+box.height), sd.width);
+  copyStr(buf[pos].bytes, use[4]);
+  for (i32 i = 0; i < box.width; i++) {
+    copyStr(buf[pos+1+i].bytes, use[1]);
+  }
+  copyStr(buf[pos+1+box.width].bytes, use[5]);
+}
+
+fn void renderUtf8CharToBuffer(Pixel* buf, u16 x, u16 y, str text, Dim2 screen_dimensions) {
+  assert(strlen(text) <= UTF8_MAX_WIDTH);
+  u32 pos = x + (screen_dimensions.width*y);
+  for (u32 i = 0; i < strlen(text); i++) {
+    buf[pos].bytes[i] = text[i];
+  }
+}
+
+fn void renderStrToBufferMaxWidth(Pixel* buf, u16 x, u16 y, str text, u16 width, Dim2 screen_dimensions) {
+  u32 pos = x + (screen_dimensions.width*y);
+  for (u32 i = 0; i < strlen(text); i++) {
+    buf[pos + (i % width)].background = 0;
+    buf[pos + (i % width)].foreground = 0;
+    buf[pos + (i % width)].attributes = 0;
+    buf[pos + (i % width)].bytes[0] = text[i];
+    if (i % width == (width-1)) {     // on last char i inside width
+      pos += screen_dimensions.width; // move pos to next line
+    }
+  }
+}
+
+fn void renderStrToBufferMaxWidthWithoutChangingColor(Pixel* buf, u16 x, u16 y, str text, u16 width, Dim2 screen_dimensions) {
+  u32 pos = x + (screen_dimensions.width*y);
+  for (u32 i = 0; i < strlen(text); i++) {
+    buf[pos + (i % width)].bytes[0] = text[i];
+    if (i % width == (width-1)) {     // on last char i inside width
+      pos += screen_dimensions.width; // move pos to next line
+    }
+  }
+}
+
+fn void renderStrToBuffer(Pixel* buf, u16 x, u16 y, str text, Dim2 screen_dimensions) {
+  u32 pos = x + (screen_dimensions.width*y);
+  for (u32 i = 0; i < strlen(text); i++) {
+    buf[pos+i].bytes[0] = text[i];
+  }
+}
+
+fn void renderStringChunkList(TuiState* tui, StringChunkList* list, u16 x, u16 y) {
+  u32 pos = XYToPos(x, y, tui->screen_dimensions.width);
+  StringChunk* chunk = list->first;
+  for (u32 i = 0; i < list->total_size; i++) {
+    if (i > 0 && i % STRING_CHUNK_PAYLOAD_SIZE == 0) {
+      chunk = chunk->next;
+    }
+    tui->frame_buffer[pos+i].bytes[0] = *((char*)(chunk + 1) + (i%STRING_CHUNK_PAYLOAD_SIZE));
+  }
+}
+
+// prints the pixel at (x, y), 1-based, in its style. the cursor ends up on the next cell, or
+// somewhere only the terminal knows after the last column
+fn void ansiPutPixel(AnsiEncoder* enc, AnsiPen* pen, Pixel* pixel, u16 x, u16 y, Pixel* shown, u16 width) {
+  ansiMoveCursor(enc, pen, x, y, shown);
+  if (pixel->background != pen->background || pixel->foreground != pen->foreground || pixel->attributes != pen->attributes) {
+    pen->background = pixel->background;
+    pen->foreground = pixel->foreground;
+    pen->attributes = pixel->attributes;
+    ansiSetStyle(enc, pen->foreground, pen->background, pen->attributes);
+  }
+  ansiPutCharacter(enc, pixel);
+  pen->x = x + 1;
+  if (x == width) pen->y = 0;
+}
+
+// the escape codes for the cells in `diff`, or without one every cell of rows
+// first_row..end_row (exclusive). expects the style to be reset, and leaves the style and
+// the cursor wherever it ends up in `pen`, so bands of rows encoded apart can go out back to back
+fn AnsiPen ansiEncodeRows(AnsiEncoder* enc, Pixel* old, Pixel* next, Dim2 sd, FrameDiff* diff, u16 first_row, u16 end_row) {
+  AnsiPen pen = {0};
+
+  if (diff == NULL) {
+    // the screen was just cleared, so the cells skipped over are blanks
+    for (u16 y = first_row + 1; y <= end_row; y++) {
+      Pixel* row = next + (y-1) * sd.width;
+      for (u16 x = 1; x <= sd.width; x++) {
+        Pixel* pixel = &row[x-1];
+        if (pixel->bytes[0] == 0) continue;
+        ansiReserve(enc, ANSI_MAX_CELL_BYTES);
+        ansiPutPixel(enc, &pen, pixel, x, y, row, sd.width);
+      }
+    }
+  } else {
+    // clearing pass, to overwrite things that were there on the last frame, but are no longer present
+    // we do this before the "rendering" pass so that multi-space characters (emojis) are easier to deal with.
+    // a move that prints cells over themselves prints them as `next` has them: those either show
+    // that already, or the rendering pass would have printed them that way anyway
+    for (u32 s = 0; s < diff->length; s++) {
+      PixelSpan span = diff->spans[s];
+      u16 y = span.row + 1;
+      for (u16 x = span.start + 1; x <= span.end; x++) {
+        u32 i = span.row * sd.width + x-1;
+        bool needs_clearing = (next[i].bytes[0] == 0 && old[i].bytes[0] != 0)
+                           || (next[i].background == 0 && old[i].background != 0)
+                           || (next[i].foreground == 0 && old[i].foreground != 0)
+                           || (next[i].attributes == 0 && old[i].attributes != 0);
+        if (needs_clearing) {
+          ansiReserve(enc, ANSI_MAX_CELL_BYTES);
+          ansiMoveCursor(enc, &pen, x, y, next + span.row * sd.width);
+          ansiPutBytes(enc, (u8*)" ", 1);
+          pen.x = x + 1;
+          if (x == sd.width) pen.y = 0;
+        }
+      }
+    }
+
+    // rendering pass, every cell in a span is known to have changed. the cells it skips
+    // over already show what `next` has in them
+    for (u32 s = 0; s < diff->length; s++) {
+      PixelSpan span = diff->spans[s];
+      u16 y = span.row + 1;
+      for (u16 x = span.start + 1; x <= span.end; x++) {
+        Pixel* is = &next[span.row * sd.width + x-1];
+        if (is->bytes[0] == 0) continue;
+        ansiReserve(enc, ANSI_MAX_CELL_BYTES);
+        ansiPutPixel(enc, &pen, is, x, y, next + span.row * sd.width, sd.width);
+      }
+    }
+  }
+  return pen;
+}
+
+// re-position the cursor according to what the rendering logic set it to, once `next` is on screen
+fn void ansiPlaceCursor(AnsiEncoder* enc, AnsiPen* pen, Pixel* next, Dim2 sd, Pos2 cursor) {
+  bool on_screen = cursor.x < sd.width && cursor.y < sd.height;
+  ansiReserve(enc, ANSI_MAX_CELL_BYTES);
+  ansiMoveCursor(enc, pen, cursor.x+1, cursor.y+1, on_screen ? next + cursor.y * sd.width : NULL);
+}
+
+// appends the escape codes that turn the terminal from showing `old` into showing `next`,
+// touching just the cells in `diff`. without a diff, draws `next` from scratch
+fn void ansiEncodeFrame(AnsiEncoder* enc, Pixel* old, Pixel* next, Dim2 sd, FrameDiff* diff, Pos2 cursor) {
+  ansiReserve(enc, ANSI_MAX_CELL_BYTES);
+  ansiPutBytes(enc, (u8*)"\033[0m\033[2J", diff == NULL ? 8 : 4);
+  AnsiPen pen = ansiEncodeRows(enc, old, next, sd, diff, 0, sd.height);
+  ansiPlaceCursor(enc, &pen, next, sd, cursor);
+}
+
+fn void tuiBandOverflow(u8* bytes, u64 length) {
+  assert(false && "a TuiBand's encoder is sized to fit its whole band");
+}
+
+// this lane's band of lanes->tui, diffed and encoded into its TuiBand
+fn void tuiLanesEncodeBand(TuiLanes* lanes) {
+  TuiState* tui = lanes->tui;
+  TuiBand* band = &lanes->bands[LaneIdx()];
+  Range1u64 rows = LaneRange(tui->screen_dimensions.height);
+  band->ansi.length = 0;
+  band->diff.length = 0;
+  band->diff.rows_compared = 0;
+  if (rows.min == rows.max) return;
+  ansiPutBytes(&band->ansi, (u8*)"\033[0m", 4);
+  if (!lanes->whole) {
+    frameDiffHashed(&band->diff, tui->back_buffer, tui->frame_buffer, tui->screen_dimensions, tui->back_row_hashes, tui->row_hashes, rows.min, rows.max);
+  }
+  band->pen = ansiEncodeRows(&band->ansi, tui->back_buffer, tui->frame_buffer, tui->screen_dimensions, lanes->whole ? NULL : &band->diff, rows.min, rows.max);
+}
+
+fn void* tuiLaneWorker(void* arg) {
+  TuiLaneWorker* worker = (TuiLaneWorker*)arg;
+  TuiLanes* lanes = worker->lanes;
+  ThreadContext tctx = {0};
+  tctxInit(&tctx);
+  LaneCtx(worker->ctx);
+  while (true) {
+    LaneSync(); // a frame is ready, or it's time to stop
+    if (lanes->quit) break;
+    tuiLanesEncodeBand(lanes);
+    LaneSync();
+  }
+  tctxFree(&tctx);
+  return NULL;
+}
+
+// `count` lanes for frames of up to `buffer_len` cells, no row wider than `max_width`
+fn void tuiLanesStart(TuiLanes* lanes, Arena* a, u32 count, u64 buffer_len, u32 max_width) {
+  assert(count > 0 && "TuiLanes needs at least the calling thread");
+  *lanes = (TuiLanes){
+    .count = count,
+    .bands = arenaAllocArray(a, TuiBand, count),
+    .workers = arenaAllocArray(a, TuiLaneWorker, count),
+    .threads = arenaAllocArray(a, Thread, count),
+  };
+  Barrier barrier = osBarrierAlloc(count);
+  // LaneRange hands a band at most one row more than its share. the diff path can put a
+  // clearing and a drawing cell's worth of escape codes in for every cell
+  u64 band_cells = buffer_len / count + max_width;
+  for (u32 i = 0; i < count; i++) {
+    lanes->bands[i].diff = frameDiffCreate(a, band_cells);
+    lanes->bands[i].ansi = ansiEncoderCreate(a, 2 * ANSI_MAX_CELL_BYTES * (band_cells + 1), tuiBandOverflow);
+    lanes->workers[i].lanes = lanes;
+    lanes->workers[i].ctx = (LaneCtx){
+      .lane_idx = i,
+      .lane_count = count,
+      .barrier = barrier,
+      .broadcast_memory = &lanes->bands[i].lane_broadcast,
+    };
+  }
+  for (u32 i = 1; i < count; i++) {
+    lanes->threads[i] = spawnThread(tuiLaneWorker, &lanes->workers[i]);
+  }
+}
+
+// the calling thread is lane 0 for the length of the frame
+fn void tuiLanesEncode(TuiLanes* lanes, TuiState* tui, bool whole) {
+  lanes->tui = tui;
+  lanes->whole = whole;
+  LaneCtx restore = LaneCtx(lanes->workers[0].ctx);
+  LaneSync();
+  tuiLanesEncodeBand(lanes);
+  LaneSync();
+  LaneCtx(restore);
+}
+
+fn void tuiLanesStop(TuiLanes* lanes) {
+  LaneCtx restore = LaneCtx(lanes->workers[0].ctx);
+  lanes->quit = true;
+  LaneSync();
+  LaneCtx(restore);
+  for (u32 i = 1; i < lanes->count; i++) {
+    osThreadJoin(lanes->threads[i], 0);
+  }
+  osBarrierRelease(lanes->workers[0].ctx.barrier);
+}
+
+fn void printfBufferAndSwap(TuiState* tui) {
+  Pixel* old = tui->back_buffer;
+  Pixel* next = tui->frame_buffer;
+  bool screen_dimensions_changed = tui->screen_dimensions.height != tui->prev_screen_dimensions.height
+    || tui->screen_dimensions.width != tui->prev_screen_dimensions.width;
+  bool should_redraw_whole_screen = screen_dimensions_changed || tui->redraw;
+
+  // the terminal hasn't taken all of an earlier frame yet. rather than queue this one behind it,
+  // drop it: the first frame after the terminal catches up shows everything this one would have
+  if (tuiWriterDrain(&TUI_WRITER) > 0) {
+    TUI_WRITER.dropped_frames += 1;
+    tui->frame_dropped = true;
+    tui->redraw = should_redraw_whole_screen;
+    tui->frame_buffer_dimensions = (Dim2){0}; // no row hashes for it, so tuiClearFrame zeroes all of it
+    MemoryZeroStruct(&tui->stats, TuiFrameStats);
+    return;
+  }
+
+  tui->frame_buffer_dimensions = tui->screen_dimensions;
+  u64 frame_bytes = (u64)tui->screen_dimensions.width * tui->screen_dimensions.height * sizeof(Pixel);
+  tui->stats.hashed_bytes = frame_bytes;
+  tui->stats.diffed_bytes = 0;
+  tui->stats.encoded_bytes = 0;
+  FrameScroll scroll = {0};
+
+  // rows whose hash didn't move are skipped by the diff.
+  // nothing changed: skip encoding and the write() call
+  frameHashRows(tui->row_hashes, next, tui->screen_dimensions);
+  if (!should_redraw_whole_screen) {
+    // rows that only moved up or down (a line inserted or deleted above them) are moved by the
+    // terminal, then the diff is against what it will show after that
+    scroll = frameFindScroll(tui->back_row_hashes, tui->row_hashes, tui->screen_dimensions);
+    if (scroll.lines != 0) {
+      frameApplyScroll(old, tui->back_row_hashes, tui->screen_dimensions, scroll);
+    }
+    bool rows_changed = false;
+    for (u16 row = 0; row < tui->screen_dimensions.height && !rows_changed; row++) {
+      rows_changed = tui->back_row_hashes[row] != tui->row_hashes[row];
+    }
+    if (!rows_changed
+        && !tui->frame_dropped
+        && scroll.lines == 0
+        && tui->prev_cursor.x == tui->cursor.x
+        && tui->prev_cursor.y == tui->cursor.y
+    ) {
+      return;
+    }
+  }
+
+  u64 flushed_before = tui->ansi.flushed;
+  ansiReserve(&tui->ansi, ANSI_MAX_CELL_BYTES);
+  ansiPutBytes(&tui->ansi, (u8*)ANSI_SYNC_BEGIN, sizeof(ANSI_SYNC_BEGIN) - 1);
+  if (scroll.lines != 0) {
+    ansiReserve(&tui->ansi, ANSI_MAX_CELL_BYTES);
+    ansiScrollRegion(&tui->ansi, scroll);
+  }
+  u64 cells = (u64)tui->screen_dimensions.width * tui->screen_dimensions.height;
+  u32 rows_compared = 0;
+  if (tui->lanes != NULL && cells >= TUI_LANES_MIN_CELLS) {
+    // the bands go out as they are, in order, right after what's been encoded so far
+    if (should_redraw_whole_screen) {
+      ansiReserve(&tui->ansi, ANSI_MAX_CELL_BYTES);
+      ansiPutBytes(&tui->ansi, (u8*)"\033[0m\033[2J", 8);
+    }
+    ansiFlush(&tui->ansi);
+    tuiLanesEncode(tui->lanes, tui, should_redraw_whole_screen);
+    AnsiPen pen = {0};
+    for (u32 i = 0; i < tui->lanes->count; i++) {
+      TuiBand* band = &tui->lanes->bands[i];
+      if (band->ansi.length > 0) {
+        tui->ansi.flush(band->ansi.bytes, band->ansi.length);
+        tui->ansi.flushed += band->ansi.length;
+        pen = band->pen;
+      }
+      rows_compared += band->diff.rows_compared;
+    }
+    ansiPlaceCursor(&tui->ansi, &pen, next, tui->screen_dimensions, tui->cursor);
+  } else {
+    if (!should_redraw_whole_screen) {
+      frameDiffHashed(&tui->diff, old, next, tui->screen_dimensions, tui->back_row_hashes, tui->row_hashes, 0, tui->screen_dimensions.height);
+      rows_compared = tui->diff.rows_compared;
+    }
+    ansiEncodeFrame(&tui->ansi, old, next, tui->screen_dimensions, should_redraw_whole_screen ? NULL : &tui->diff, tui->cursor);
+  }
+  tui->stats.diffed_bytes = 2 * (u64)rows_compared * tui->screen_dimensions.width * sizeof(Pixel);
+  ansiReserve(&tui->ansi, ANSI_MAX_CELL_BYTES);
+  ansiPutBytes(&tui->ansi, (u8*)ANSI_SYNC_END, sizeof(ANSI_SYNC_END) - 1);
+  // finally write our whole string to the terminal
+  ansiFlush(&tui->ansi);
+  tui->frame_dropped = false;
+  tui->stats.encoded_bytes = tui->ansi.flushed - flushed_before;
+
+  // swap our buffers
+  Pixel* tmp = tui->back_buffer;
+  tui->back_buffer = tui->frame_buffer;
+  tui->frame_buffer = tmp;
+  u64* tmp_hashes = tui->back_row_hashes;
+  tui->back_row_hashes = tui->row_hashes;
+  tui->row_hashes = tmp_hashes;
+  Dim2 tmp_dimensions = tui->back_buffer_dimensions;
+  tui->back_buffer_dimensions = tui->frame_buffer_dimensions;
+  tui->frame_buffer_dimensions = tmp_dimensions;
+
+  // reset the `redraw` flag
+  tui->redraw = false;
+}
+
+fn u32 matchCommandPaletteCommands(String current_search, CommandPaletteCommandList commands, u32 menu_index, u32* scores, StringSearchScore* score_details) {
+  // returns the `commands` id that matches the `menu_index`
+  for (u32 i = 0; i < commands.length; i++) {
+    CommandPaletteCommand* cmd = &commands.items[i];
+    bool name_matches = false;
+    for (u32 j = 0; j < strlen(cmd->display_name); j++) {
+      if (current_search.length > 0 && lowerAscii(cmd->display_name[j]) == lowerAscii(current_search.bytes[0])) {
+        for (u32 k = 0; k < current_search.length && k+j < strlen(cmd->display_name); k++) {
+          if (lowerAscii(current_search.bytes[k]) != lowerAscii(cmd->display_name[j+k])) {
+            break;
+          }
+          if (k == current_search.length - 1) {
+            name_matches = true;
+            score_details[i].name_match_start = j;
+            score_details[i].name_match_len = current_search.length;
+          }
+        }
+      }
+    }
+    bool description_matches = false;
+    u32 tag_match_count = 0;
+    scores[i] = (name_matches * 100 * MAX_COMMAND_PALETTE_COMMANDS) +
+                (description_matches * 10 * MAX_COMMAND_PALETTE_COMMANDS) +
+                (tag_match_count * MAX_COMMAND_PALETTE_COMMANDS) +
+                cmd->id;
+    score_details[i].score = scores[i];
+    score_details[i].name_matched = name_matches;
+    score_details[i].description_matched = description_matches;
+    score_details[i].tag_match_count = tag_match_count;
+  }
+  u32Quicksort(scores, 0, commands.length - 1);
+  u32ReverseArray(scores, commands.length);
+  return (scores[menu_index] % MAX_COMMAND_PALETTE_COMMANDS);
+}
+
+fn Pos2 renderCommandPalette(TuiState* tui, String current_search, CommandPaletteCommandList commands, u32 menu_index) {
+  // returns the cursor position as Pos2
+
+  ScratchMem scratch = scratchGet();
+  Dim2 sd = tui->screen_dimensions;
+  Pos2 result = { 0 };
+
+  // draw the outline
+  Box outline = {
+    .width = sd.width / 2,
+    .height = sd.height / 2,
+  };
+  outline.x = outline.width / 2;
+  outline.y = outline.height / 2;
+  drawAnsiBox(tui->frame_buffer, outline, sd, true);
+
+  // draw the "search bar"
+  result.x = outline.x + 1 + current_search.length;
+  result.y = outline.y + 1;
+  renderStrToBufferMaxWidth(tui->frame_buffer, outline.x+1, outline.y+1, current_search.bytes, outline.width - 2, sd);
+  for (u32 i = 1; i < outline.width-1; i++) {
+    u32 pos = XYToPos(outline.x+1, outline.y+2, sd.width);
+    copyStr(tui->frame_buffer[pos].bytes, "━");
+  }
+
+  // sort the command options
+  u32* scores = arenaAllocArray(&scratch.arena, u32, commands.length);
+  StringSearchScore* score_details = arenaAllocArray(&scratch.arena, StringSearchScore, commands.length);
+  matchCommandPaletteCommands(current_search, commands, menu_index, scores, score_details);
+
+  // draw the command options
+  u32 x = outline.x + 1;
+  u32 y = outline.y + 3;
+  for (u32 i = 0; (y-outline.y) < (outline.height-1) && i < commands.length; i++, y+=2) {
+    if (i == menu_index) {
+      for (u32 ii = 0; ii < outline.width-1; ii++) {
+        u32 pos = XYToPos(x+ii, y, tui->screen_dimensions.width);
+        tui->frame_buffer[pos].bytes[0] = ' ';
+        tui->frame_buffer[pos].foreground = ANSI_BLACK;
+        tui->frame_buffer[pos].background = ANSI_WHITE;
+        pos = XYToPos(x+ii, y+1, tui->screen_dimensions.width);
+        tui->frame_buffer[pos].bytes[0] = ' ';
+        tui->frame_buffer[pos].foreground = ANSI_BLACK;
+        tui->frame_buffer[pos].background = ANSI_WHITE;
+      }
+    }
+    u32 id = scores[i] % MAX_COMMAND_PALETTE_COMMANDS;
+    StringSearchScore score = score_details[id];
+    CommandPaletteCommand* cmd = NULL;
+    for (u32 j = 0; j < commands.length; j++) {
+      if (commands.items[j].id == id) {
+        cmd = &commands.items[j];
+        break;
+      }
+    }
+    assert(cmd != NULL);
+    if (score.name_matched) {
+      u32 end_idx = score.name_match_len + score.name_match_start;
+      for (u32 ii = 0; ii < strlen(cmd->display_name); ii++) {
+        u32 pos = XYToPos(x+ii, y, tui->screen_dimensions.width);
+        if (ii >= score.name_match_start && ii < end_idx) {
+          if (i == menu_index) {
+            tui->frame_buffer[pos].foreground = ANSI_DULL_RED;
+          } else {
+            tui->frame_buffer[pos].foreground = ANSI_HIGHLIGHT_YELLOW;
+            tui->frame_buffer[pos].background = 0;
+          }
+        }
+        tui->frame_buffer[pos].bytes[0] = cmd->display_name[ii];
+      }
+    } else {
+      renderStrToBufferMaxWidthWithoutChangingColor(tui->frame_buffer, x, y, cmd->display_name, outline.width - 2, sd);
+    }
+    renderStrToBufferMaxWidthWithoutChangingColor(tui->frame_buffer, x, y+1, cmd->description, outline.width - 2, sd);
+  }
+
+  scratchReturn(&scratch);
+  return result;
+}
+
+fn void renderChoiceMenu(TuiState* tui, u16 x, u16 y, ptr options[], u32 len, bool choosable, u32 selected_index, u8* colors) {
+  for (u32 i = 0; i < len; i++) {
+    u32 pos = x + (tui->screen_dimensions.width*(y+i));
+    if (choosable && selected_index == i) {
+      tui->cursor.x = x;
+      tui->cursor.y = y+i;
+    }
+    u8 bytes[80] = {0};
+    sprintf((char*)bytes, "- %d. ", i+1);
+    u32 offset = strlen((char*)bytes);
+    u32 bytes_remaining = (80 - offset);
+    for (
+      u32 j = 0;
+      j < strlen(options[i]) && j < bytes_remaining;
+      j++
+    ) {
+      bytes[offset+j] = options[i][j];
+    }
+    // write our `bytes` buffer into the Pixel* buf
+    for (u32 j = 0; j < 80; j++) {
+      tui->frame_buffer[pos+j].bytes[0] = bytes[j];
+      if (choosable && selected_index == i) {
+        tui->frame_buffer[pos+j].foreground = ANSI_BLACK;
+        tui->frame_buffer[pos+j].background = ANSI_WHITE;
+      } else {
+        tui->frame_buffer[pos+j].foreground = colors == NULL ? ANSI_WHITE : colors[i];
+        tui->frame_buffer[pos+j].background = ANSI_BLACK;
+      }
+    }
+  }
+}
+
+fn void* tuiPipelineWriter(void* arg) {
+  TuiPipeline* p = (TuiPipeline*)arg;
+  TuiState* out = &p->out;
+  ThreadContext tctx = {0}; // TuiLanes runs its lane 0 on this thread
+  tctxInit(&tctx);
+  while (true) {
+    // the terminal takes all of one frame before the next one is picked, so the writer never
+    // drops frames itself, and what it picks is as new as it can be
+    tuiWriterFinish(&TUI_WRITER);
+    lockMutex(&p->mutex); {
+      while (p->published == -1 && !p->quit) {
+        waitForCondSignal(&p->cond, &p->mutex);
+      }
+      if (p->published == -1) {
+        unlockMutex(&p->mutex);
+        break;
+      }
+      TuiPipelineSlot* slot = &p->slots[p->published];
+      p->published = -1;
+      out->frame_buffer = slot->pixels;
+      out->row_hashes = slot->row_hashes;
+      out->frame_buffer_dimensions = slot->dimensions;
+      out->prev_screen_dimensions = out->screen_dimensions;
+      out->screen_dimensions = p->published_dimensions;
+      out->prev_cursor = out->cursor;
+      out->cursor = p->published_cursor;
+      out->redraw = p->published_redraw;
+    } unlockMutex(&p->mutex);
+
+    printfBufferAndSwap(out);
+
+    // whichever buffer isn't on screen now goes back to the loop
+    lockMutex(&p->mutex); {
+      for (u32 i = 0; i < TUI_PIPELINE_SLOTS; i++) {
+        if (p->slots[i].pixels == out->frame_buffer) {
+          p->slots[i].row_hashes = out->row_hashes;
+          p->slots[i].dimensions = out->frame_buffer_dimensions;
+          p->slots[i].free = true;
+        }
+      }
+    } unlockMutex(&p->mutex);
+  }
+  tuiWriterFinish(&TUI_WRITER);
+  tctxFree(&tctx);
+  return NULL;
+}
+
+// the writer gets a TuiState of its own, and its two buffers plus the loop's two are the slots
+fn void tuiPipelineStart(TuiPipeline* p, Arena* a, TuiState* tui) {
+  p->mutex = newMutex();
+  p->cond = newCond();
+  p->out = tuiInit(a, tui->buffer_len);
+  p->out.ansi.flush = tui->ansi.flush;
+  p->out.lanes = tui->lanes;
+  p->published = -1;
+  p->drawing = -1;
+  Pixel* pixels[TUI_PIPELINE_SLOTS] = { p->out.back_buffer, p->out.frame_buffer, tui->frame_buffer, tui->back_buffer };
+  u64* hashes[TUI_PIPELINE_SLOTS] = { p->out.back_row_hashes, p->out.row_hashes, tui->row_hashes, tui->back_row_hashes };
+  for (u32 i = 0; i < TUI_PIPELINE_SLOTS; i++) {
+    p->slots[i] = (TuiPipelineSlot){ .pixels = pixels[i], .row_hashes = hashes[i], .free = i != 0 };
+  }
+  p->thread = spawnThread(tuiPipelineWriter, p);
+}
+
+// points the loop's frame_buffer at a free slot, in place of tuiClearFrame's usual buffer
+fn void tuiPipelineAcquire(TuiPipeline* p, TuiState* tui) {
+  lockMutex(&p->mutex); {
+    for (u32 i = 0; i < TUI_PIPELINE_SLOTS && p->drawing == -1; i++) {
+      if (p->slots[i].free) p->drawing = i;
+    }
+    assert(p->drawing != -1 && "TuiPipeline ran out of slots");
+    TuiPipelineSlot* slot = &p->slots[p->drawing];
+    slot->free = false;
+    tui->frame_buffer = slot->pixels;
+    tui->row_hashes = slot->row_hashes;
+    tui->frame_buffer_dimensions = slot->dimensions;
+  } unlockMutex(&p->mutex);
+}
+
+// hands the drawn frame to the writer, replacing one it hasn't gotten to yet
+fn void tuiPipelinePublish(TuiPipeline* p, TuiState* tui) {
+  lockMutex(&p->mutex); {
+    bool redraw = tui->redraw;
+    if (p->published != -1) {
+      // its row hashes were never filled in, so tuiClearFrame zeroes all of it next time
+      p->slots[p->published].dimensions = (Dim2){0};
+      p->slots[p->published].free = true;
+      redraw = redraw || p->published_redraw;
+      p->skipped_frames += 1;
+    }
+    p->slots[p->drawing].dimensions = tui->frame_buffer_dimensions;
+    p->published = p->drawing;
+    p->published_dimensions = tui->screen_dimensions;
+    p->published_cursor = tui->cursor;
+    p->published_redraw = redraw;
+    p->drawing = -1;
+    signalCond(&p->cond);
+  } unlockMutex(&p->mutex);
+  tui->redraw = false;
+}
+
+// the writer finishes the last frame it was given, then exits
+fn void tuiPipelineStop(TuiPipeline* p) {
+  lockMutex(&p->mutex); {
+    p->quit = true;
+    signalCond(&p->cond);
+  } unlockMutex(&p->mutex);
+  osThreadJoin(p->thread, 0);
+}
+
+fn void infiniteUILoop(
+  u32 max_screen_width,
+  u32 max_screen_height,
+  u64 goal_input_loop_us,
+  void* state,
+  // updateAndRender should return a bool `should_quit`
+  bool (*updateAndRender)(TuiState* tui, void* state, u8* input_buffer, u64 loop_count)
+) {
+  bool should_quit = false;
+  Arena permanent_arena = {0};
+  arenaInit(&permanent_arena);
+  // set up the TUI incantations
+  TermIOs old_terminal_attributes = osStartTUI(false);
+  TuiState tui = tuiInit(&permanent_arena, max_screen_width*max_screen_height);
+  TUI_WRITER = tuiWriterCreate(&permanent_arena, TUI_OUTPUT_RING_BYTES);
+  tui.screen_dimensions = osGetTerminalDimensions();
+  TuiLanes lanes = {0};
+  if (TUI_ENCODE_LANES > 1) {
+    tuiLanesStart(&lanes, &permanent_arena, TUI_ENCODE_LANES, tui.buffer_len, max_screen_width);
+    tui.lanes = &lanes;
+  }
+  bool pipelined = TUI_PIPELINED;
+  TuiPipeline pipeline = {0};
+  if (pipelined) {
+    tuiPipelineStart(&pipeline, &permanent_arena, &tui);
+  }
+
+  // on linux, sleep until a key, a resize or a requested wake instead of polling every frame
+  bool event_driven = false;
+#if OS_LINUX
+  OsEventLoop events = {0};
+  if (!TUI_FORCE_POLLING) {
+    events = osEventLoopCreate();
+    event_driven = events.epoll != -1;
+  }
+#endif
+  u32 happened = 0;
+
+  // ui loop (read input, simulate next frame, render)
+  u8 input_buffer[5] = {0};
+  u64 loop_start;
+  u64 loop_count = 0;
+  while (!should_quit) {
+    loop_count += 1;
+    loop_start = osTimeMicrosecondsNow();
+
+    // both reads local input from the keyboard AND from the network
+    osReadConsoleInput(input_buffer, 4);
+
+    // prep rendering
+    tui.prev_screen_dimensions = tui.screen_dimensions;
+    bool check_dimensions = event_driven
+      ? (happened & OS_EVENT_RESIZE) != 0
+      : loop_count % 17 == 0; // every 17 frames, update our terminal_dimensions
+    if (check_dimensions) {
+      tui.screen_dimensions = osGetTerminalDimensions();
+    }
+    if (pipelined) {
+      tuiPipelineAcquire(&pipeline, &tui);
+    }
+    tuiClearFrame(&tui);
+    tui.prev_cursor = tui.cursor;// save last frame's cursor
+    tui.wake_in_us = 0;
+
+    // operate on input + render new tui.frame_buffer
+    should_quit = updateAndRender(&tui, state, input_buffer, loop_count);
+
+    if (pipelined) {
+      tuiPipelinePublish(&pipeline, &tui);
+    } else {
+      printfBufferAndSwap(&tui);
+    }
+
+    // loop timing
+    if (event_driven) {
+#if OS_LINUX
+      // also wake when the terminal can take more of a frame it's behind on. if it took some
+      // but not all, there's still no point drawing another one. the pipeline's writer does
+      // its own waiting on the terminal
+      if (pipelined && !should_quit) {
+        happened = osEventWait(&events, tui.wake_in_us);
+      }
+      while (!pipelined && !should_quit) {
+        osEventWatchOutput(&events, tuiWriterDrain(&TUI_WRITER) > 0);
+        happened = osEventWait(&events, tui.wake_in_us);
+        if (happened != OS_EVENT_OUTPUT || tuiWriterDrain(&TUI_WRITER) == 0) break;
+      }
+#endif
+    } else {
+      u32 loop_duration = osTimeMicrosecondsNow() - loop_start;
+      i32 remaining_time = goal_input_loop_us - loop_duration;
+      if (remaining_time > 0) {
+        osSleepMicroseconds(remaining_time);
+      }
+    }
+  }
+
+#if OS_LINUX
+  if (event_driven) {
+    osEventLoopRelease(&events);
+  }
+#endif
+  if (pipelined) {
+    tuiPipelineStop(&pipeline);
+  }
+  if (tui.lanes != NULL) {
+    tuiLanesStop(&lanes);
+  }
+  tuiWriterFinish(&TUI_WRITER);
+  // cleanup terminal TUI incantations
+  osEndTUI(old_terminal_attributes);
+}
+
@@ -0,0 +1,727 @@
+#include "base/impl.c"
+#include "string_chunk.c"
+#include "tree_render.c"
+#include "journal.c"
+
+///// #DEFINES
+#define MAX_SCREEN_HEIGHT 300
+#define MAX_SCREEN_WIDTH 800
+#define GOAL_INPUT_LOOPS_PER_S 60
+#define GOAL_INPUT_LOOP_US 1000000/GOAL_INPUT_LOOPS_PER_S
+#define PRIMITIVE_TYPE_COUNT (30)
+#define COMPACT_MIN_FREE_NODES (1024)
+#define COMPACT_IDLE_US (250000) // how long after the last keystroke an idle compaction may run
+#define SAVED_INDICATOR_US (1600000)
+#define MAX_VIEWS (32)
+#define TREE_PANE_X (2)
+#define TREE_PANE_Y (2)
+
+///// TYPES
+typedef enum Command {
+  CommandInsertSiblingBefore,
+  CommandInsertSiblingAfter,
+  CommandQuit,
+  CommandMoveToParent,
+  CommandMoveToFirstChild,
+  CommandDeleteNode,
+  CommandUndo,
+  CommandRedo,
+  CommandYank,
+  CommandPasteAfter,
+  CommandPasteBefore,
+  CommandSplitView,
+  CommandNextView,
+  CommandCloseView,
+  Command_Count
+} Command;
+
+typedef enum Mode {
+  ModeNormal,
+  ModeEdit,
+  Mode_Count
+} Mode;
+str MODE_STRINGS[Mode_Count] = {"Normal", "Edit"};
+
+// a pane onto the shared tree: just a subtree to show, where it's scrolled to, and
+// its rendered layout. views never copy nodes, so every pane sees every edit.
+typedef struct View {
+  NodeHandle root;
+  NodeHandle selected; // the cursor, while the view isn't the active one
+  u32 scroll_row;
+  ViewCache cache;
+} View;
+
+typedef struct Views {
+  u32 length;
+  u32 capacity;
+  Arena arena;
+  View* items;
+} Views;
+
+typedef struct State {
+  bool should_quit;
+  bool pending_command;
+  bool show_command_palette;
+  Mode mode;
+  NodeHandle selected_node;
+  NodeHandle function_node;
+  u64 saved_on; // osTimeMicrosecondsNow() of the last save
+  CTree tree;
+  TreeLayout layout;
+  Journal journal;
+  CTreeClip clip;
+  u32 selected_view;
+  Views views;
+  u32 node_section;
+  u32 menu_index;
+  StringArena string_arena;
+  Arena permanent_arena;
+  CommandPaletteCommandList commands;
+  StringChunkList cmd_palette_search_input;
+} State;
+
+///// GLOBALS
+// NOTE: keep these .id = fields in sync with `typedef enum Command`
+global const CommandPaletteCommand COMMANDS[Command_Count] = {
+  { .id = 0, .display_name = "Insert Sibling Node Before (I)",
+    .description = "Insert a new node on the same conceptual 'level' of the tree.",
+    .tags = {"new node", "insert", "sibling", "add node", "add item", "add element", "new item", "new element"},
+  },
+  { .id = 1, .display_name = "Insert Sibling Node After (i)",
+    .description = "Insert a new node on the same conceptual 'level' of the tree.",
+    .tags = {"new node", "insert", "sibling", "add node", "add item", "add element", "new item", "new element"},
+  },
+  { .id = 2, .display_name = "Quit (q)",
+    .description = "Quit the application.",
+    .tags = {"quit", "exit", "close"},
+  },
+  { .id = 3, .display_name = "Move to Parent Node (h/←)",
+    .description = "Move the cursor to the node's parent node.",
+    .tags = {"parent", "move", "up", "left"},
+  },
+  { .id = 4, .display_name = "Move to First Child Node (l/→)",
+    .description = "Move the cursor to the node's first child node.",
+    .tags = {"child", "move", "down", "right"},
+  },
+  { .id = 5, .display_name = "Delete Node (d)",
+    .description = "Delete the node and everything inside of it.",
+    .tags = {"delete", "remove", "cut", "node"},
+  },
+  { .id = 6, .display_name = "Undo (u)",
+    .description = "Undo the last change to the tree.",
+    .tags = {"undo", "revert", "back"},
+  },
+  { .id = 7, .display_name = "Redo (ctrl+r)",
+    .description = "Redo the last change that was undone.",
+    .tags = {"redo", "again", "forward"},
+  },
+  { .id = 8, .display_name = "Yank Node (y)",
+    .description = "Copy the node and everything inside of it.",
+    .tags = {"yank", "copy", "duplicate", "clipboard"},
+  },
+  { .id = 9, .display_name = "Paste After (p)",
+    .description = "Paste the last yanked node as the next sibling.",
+    .tags = {"paste", "put", "duplicate", "clipboard"},
+  },
+  { .id = 10, .display_name = "Paste Before (P)",
+    .description = "Paste the last yanked node as the previous sibling.",
+    .tags = {"paste", "put", "duplicate", "clipboard"},
+  },
+  { .id = 11, .display_name = "Split View (v)",
+    .description = "Open a new pane showing the selected node and everything inside of it.",
+    .tags = {"split", "view", "pane", "window", "open"},
+  },
+  { .id = 12, .display_name = "Next View (w)",
+    .description = "Move the cursor to the next pane.",
+    .tags = {"next", "view", "pane", "window", "switch"},
+  },
+  { .id = 13, .display_name = "Close View (c)",
+    .description = "Close the current pane. The first pane can't be closed.",
+    .tags = {"close", "view", "pane", "window"},
+  },
+};
+
+global str PRIMITIVE_TYPES[PRIMITIVE_TYPE_COUNT] = {
+  "bool", "char", "int", "float", "double", "short", "long",
+  "signed char", "unsigned char",
+  "short int", "signed short", "signed short int",
+  "unsigned short", "unsigned short int",
+  "signed", "signed int",
+  "unsigned", "unsigned int",
+  "long int", "signed long", "signed long int",
+  "unsigned long", "unsigned long int",
+  "long long", "long long int", "signed long long", "signed long long int",
+  "unsigned long long", "unsigned long long int",
+  "long double"
+};
+global const String EMPTY_STRING = {
+  .bytes = "",
+  .length = 0,
+  .capacity = 1,
+};
+
+///// functions()
+fn PtrArray listMatchingTypes(Arena* a, StringChunkList list) {
+  String type_name = stringChunkToString(a, list);
+  u32 matching_count = 0;
+  for (u32 i = 0; i < PRIMITIVE_TYPE_COUNT; i++) {
+    if (strstr(PRIMITIVE_TYPES[i], type_name.bytes) != NULL) {
+      matching_count += 1;
+    }
+  }
+  PtrArray result = {
+    .length = matching_count,
+    .capacity = matching_count,
+    .items = arenaAllocArray(a, ptr, matching_count),
+  };
+  u32 result_index = 0;
+  for (u32 i = 0; i < PRIMITIVE_TYPE_COUNT; i++) {
+    if (strstr(PRIMITIVE_TYPES[i], type_name.bytes) != NULL) {
+      result.items[result_index] = (ptr)PRIMITIVE_TYPES[i];
+      result_index += 1;
+    }
+  }
+  arenaDealloc(a, type_name.capacity);
+  return result;
+}
+
+// whether `ancestor` is `node` or one of its ancestors
+fn bool isNodeUnder(CTree* tree, NodeHandle node, NodeHandle ancestor) {
+  // the root is its own parent, so stop there instead of following it forever
+  for (NodeHandle h = node; h != NODE_NIL; h = nodeFromHandle(tree, h)->parent) {
+    if (h == ancestor) return true;
+    if (h == tree->root) break;
+  }
+  return false;
+}
+
+fn View* activeView(State* s) {
+  return &s->views.items[s->selected_view];
+}
+
+fn void switchView(State* s, u32 index) {
+  activeView(s)->selected = s->selected_node;
+  s->selected_view = index;
+  s->selected_node = activeView(s)->selected;
+}
+
+fn void openView(State* s, NodeHandle root) {
+  if (s->views.length == s->views.capacity) return; // TODO message that there are too many views
+  View* view = &s->views.items[s->views.length];
+  if (view->cache.arena.memory == NULL) { // closed views keep their cache around for the next one
+    view->cache = viewCacheCreate();
+  }
+  view->root = root;
+  view->selected = root;
+  view->scroll_row = 0;
+  switchView(s, s->views.length++);
+}
+
+fn void closeView(State* s, u32 index) {
+  assert(index > 0 && "the first view always shows the whole tree");
+  if (index == s->selected_view) {
+    switchView(s, index - 1);
+  } else if (index < s->selected_view) {
+    s->selected_view -= 1;
+  }
+  View closed = s->views.items[index];
+  for (u32 v = index; v + 1 < s->views.length; v++) {
+    s->views.items[v] = s->views.items[v+1];
+  }
+  s->views.length -= 1;
+  s->views.items[s->views.length] = closed;
+}
+
+fn bool doCommand(State* s, u32 cmd_id) {
+  bool result = true;
+  Command cmd_type = (Command)cmd_id;
+  CNode* selected = nodeFromHandle(&s->tree, s->selected_node);
+  // the view's root stands in for the tree's root: new nodes go inside it, not next to it
+  NodeHandle view_root = activeView(s)->root;
+  switch (cmd_type) {
+    case CommandInsertSiblingAfter: {
+      // insert sibling BELOW
+      s->mode = ModeEdit;
+      if (s->selected_node == view_root) { // the root has no siblings, so add to its children instead
+        s->selected_node = journalInsertNode(&s->journal, &s->tree, &s->string_arena, NodeTypeIncomplete, view_root, selected->last_child);
+      } else {
+        s->selected_node = journalInsertNode(&s->journal, &s->tree, &s->string_arena, NodeTypeIncomplete, selected->parent, s->selected_node);
+      }
+    } break;
+    case CommandInsertSiblingBefore: {
+      // insert sibling ABOVE
+      s->mode = ModeEdit;
+      if (s->selected_node == view_root) {
+        s->selected_node = journalInsertNode(&s->journal, &s->tree, &s->string_arena, NodeTypeIncomplete, view_root, NODE_NIL);
+      } else {
+        s->selected_node = journalInsertNode(&s->journal, &s->tree, &s->string_arena, NodeTypeIncomplete, selected->parent, selected->prev_sibling);
+      }
+    } break;
+    case CommandMoveToParent: {
+      if (s->selected_node != view_root) {
+        s->selected_node = selected->parent;
+      }
+    } break;
+    case CommandMoveToFirstChild: {
+      if (selected->first_child != NODE_NIL) {
+        s->selected_node = selected->first_child;
+      }
+    } break;
+    case CommandDeleteNode: {
+      if (s->selected_node == s->tree.root) {
+        break; // TODO message that you can't delete the root node
+      }
+      NodeHandle deleted = s->selected_node;
+      if (selected->next_sibling != NODE_NIL) {
+        s->selected_node = selected->next_sibling;
+      } else if (selected->prev_sibling != NODE_NIL) {
+        s->selected_node = selected->prev_sibling;
+      } else {
+        s->selected_node = selected->parent;
+      }
+      journalDeleteNode(&s->journal, &s->tree, &s->string_arena, deleted);
+    } break;
+    case CommandUndo: {
+      NodeHandle focus = journalUndo(&s->journal, &s->tree, &s->string_arena);
+      if (focus != NODE_NIL) {
+        s->selected_node = focus;
+      }
+    } break;
+    case CommandRedo: {
+      NodeHandle focus = journalRedo(&s->journal, &s->tree, &s->string_arena);
+      if (focus != NODE_NIL) {
+        s->selected_node = focus;
+      }
+    } break;
+    case CommandYank: {
+      if (s->selected_node != s->tree.root) {
+        cTreeYank(&s->tree, s->selected_node, &s->clip);
+      }
+    } break;
+    case CommandPasteAfter: {
+      if (s->clip.node_count == 0) break;
+      if (s->selected_node == view_root) {
+        s->selected_node = journalPaste(&s->journal, &s->tree, &s->string_arena, &s->clip, view_root, selected->last_child);
+      } else {
+        s->selected_node = journalPaste(&s->journal, &s->tree, &s->string_arena, &s->clip, selected->parent, s->selected_node);
+      }
+    } break;
+    case CommandPasteBefore: {
+      if (s->clip.node_count == 0) break;
+      if (s->selected_node == view_root) {
+        s->selected_node = journalPaste(&s->journal, &s->tree, &s->string_arena, &s->clip, view_root, NODE_NIL);
+      } else {
+        s->selected_node = journalPaste(&s->journal, &s->tree, &s->string_arena, &s->clip, selected->parent, selected->prev_sibling);
+      }
+    } break;
+    case CommandSplitView: {
+      openView(s, s->selected_node);
+    } break;
+    case CommandNextView: {
+      switchView(s, (s->selected_view + 1) % s->views.length);
+    } break;
+    case CommandCloseView: {
+      if (s->selected_view > 0) {
+        closeView(s, s->selected_view);
+      }
+    } break;
+    case CommandQuit: {
+      s->should_quit = true;
+    } break;
+
+    default:
+    case Command_Count:
+      result = false;
+    break;
+  }
+  return result;
+}
+
+fn bool updateAndRender(TuiState* tui, void* state, u8* input_buffer, u64 loop_count) {
+  State* s = (State*)state;
+  ScratchMem scratch = scratchGet();
+
+  // re-pack the node pool while the user isn't typing, once enough deleted slots pile up
+  bool idle = input_buffer[0] == 0;
+  bool needs_compaction = s->tree.free_count >= COMPACT_MIN_FREE_NODES && s->tree.free_count * 4 >= s->tree.length;
+  if (!idle && needs_compaction) {
+    tui->wake_in_us = COMPACT_IDLE_US; // the loop may not come around again until the next key
+  }
+  if (idle && needs_compaction) {
+    u32 external_count = 2 + 2*s->views.length;
+    NodeHandle** external = arenaAllocArray(&scratch.arena, NodeHandle*, external_count);
+    external_count = 0;
+    external[external_count++] = &s->selected_node;
+    external[external_count++] = &s->function_node;
+    for (u32 v = 0; v < s->views.length; v++) {
+      external[external_count++] = &s->views.items[v].root;
+      external[external_count++] = &s->views.items[v].selected;
+    }
+    cTreeCompact(&s->tree, external, external_count);
+  }
+
+  // a view whose root was deleted (or undone away) has nothing left to show
+  for (u32 v = s->views.length - 1; v > 0; v--) {
+    NodeHandle root = s->views.items[v].root;
+    if (!isNodeHandleValid(&s->tree, root) || !isNodeUnder(&s->tree, root, s->tree.root)) {
+      closeView(s, v);
+    }
+  }
+  // an undo or a delete can move the cursor out of the view
+  if (!isNodeHandleValid(&s->tree, s->selected_node) || !isNodeUnder(&s->tree, s->selected_node, activeView(s)->root)) {
+    s->selected_node = activeView(s)->root;
+  }
+
+  // "always" rendering logic
+  // indicate if we saved
+  u64 now = osTimeMicrosecondsNow();
+  if (s->saved_on && (now - s->saved_on < SAVED_INDICATOR_US)) {
+    renderStrToBuffer(tui->frame_buffer, 1, 0, "saved", tui->screen_dimensions);
+    tui->wake_in_us = SAVED_INDICATOR_US - (now - s->saved_on); // to take it down again
+  }
+  // indicate what mode we are in
+  renderStrToBuffer(tui->frame_buffer, 0, 0, MODE_STRINGS[s->mode], tui->screen_dimensions);
+  // MAIN RENDER of CODE TREE
+  layoutSync(&s->layout, &s->tree);
+  // the views share the space below the status line as side by side panes
+  Dim2 sd = tui->screen_dimensions;
+  u32 pane_area_width = sd.width > TREE_PANE_X ? sd.width - TREE_PANE_X : 0;
+  u32 separators = s->views.length - 1;
+  u32 pane_width = pane_area_width > separators ? (pane_area_width - separators) / s->views.length : 0;
+  u32 pane_height = sd.height > TREE_PANE_Y ? sd.height - TREE_PANE_Y : 0;
+  Pointu32 selected_at = {0}; // where the cursor node is on screen
+  for (u32 v = 0; v < s->views.length; v++) {
+    View* view = &s->views.items[v];
+    Box pane = { .x = TREE_PANE_X + v*(pane_width + 1), .y = TREE_PANE_Y, .width = pane_width, .height = pane_height };
+    // don't leave the view scrolled past its end after a delete shrinks it
+    u32 content_height = s->layout.nodes[nodeHandleIndex(view->root)].height;
+    if (view->scroll_row + pane.height > content_height) {
+      view->scroll_row = content_height > pane.height ? content_height - pane.height : 0;
+    }
+    if (v == s->selected_view) {
+      Pointu32 at = layoutPosition(&s->layout, &s->tree, s->selected_node, view->root);
+      if (at.y < view->scroll_row) {
+        view->scroll_row = at.y;
+      } else if (pane.height > 0 && at.y >= view->scroll_row + pane.height) {
+        view->scroll_row = at.y - pane.height + 1;
+      }
+      selected_at.x = pane.x + at.x;
+      selected_at.y = pane.y + at.y - view->scroll_row;
+    }
+    viewCacheSync(&view->cache, &s->tree, &s->layout, view->root, view->scroll_row, pane.width, pane.height);
+    viewCacheBlit(&view->cache, tui, pane.x, pane.y);
+    if (v > 0 && pane.x - 1 < sd.width) {
+      for (u32 y = pane.y; y < sd.height; y++) {
+        tui->frame_buffer[pane.x - 1 + y*sd.width].bytes[0] = '|';
+      }
+    }
+  }
+  CNode* selected = nodeFromHandle(&s->tree, s->selected_node);
+  tui->cursor.x = selected_at.x;
+  tui->cursor.y = selected_at.y;
+
+  // input/mode-dependent rendering logic
+  String input_string = {
+    .bytes = (ptr)input_buffer,
+    .length = strlen((ptr)input_buffer),
+    .capacity = strlen((ptr)input_buffer)+1,
+  };
+  bool left_arrow_pressed = input_buffer[0] == 27 && input_buffer[1] == 91 && input_buffer[2] == 68;
+  bool right_arrow_pressed = input_buffer[0] == 27 && input_buffer[1] == 91 && input_buffer[2] == 67;
+  bool down_arrow_pressed = input_buffer[0] == 27 && input_buffer[1] == 91 && input_buffer[2] == 66;
+  bool up_arrow_pressed = input_buffer[0] == 27 && input_buffer[1] == 91 && input_buffer[2] == 65;
+  bool esc_pressed = input_buffer[0] == ASCII_ESCAPE && input_buffer[1] == 0;
+  bool tab_pressed = input_buffer[0] == ASCII_TAB;
+  bool enter_pressed = input_buffer[0] == ASCII_RETURN || input_buffer[0] == ASCII_LINE_FEED;
+  bool backspace_pressed = input_buffer[0] == ASCII_BACKSPACE || input_buffer[0] == ASCII_DEL;
+  switch (s->mode) {
+    case ModeNormal: {
+      if (s->show_command_palette) {
+        String search = stringChunkToString(&scratch.arena, s->cmd_palette_search_input);
+
+        if (esc_pressed) {
+          s->show_command_palette = false;
+        } else if (isAlphaUnderscoreSpace(input_buffer[0])) {
+          stringChunkListAppend(&s->string_arena, &s->cmd_palette_search_input, input_string);
+        } else if (backspace_pressed) {
+          stringChunkListDeleteLast(&s->string_arena, &s->cmd_palette_search_input);
+        } else if (up_arrow_pressed) {
+          s->menu_index -= 1;
+        } else if (down_arrow_pressed) {
+          s->menu_index += 1;
+        } else if (enter_pressed || tab_pressed) {
+          u32* scores = arenaAllocArray(&scratch.arena, u32, s->commands.length);
+          StringSearchScore* score_details = arenaAllocArray(&scratch.arena, StringSearchScore, s->commands.length);
+          u32 cmd_id = matchCommandPaletteCommands(search, s->commands, s->menu_index, scores, score_details);
+          s->menu_index = 0;
+          s->show_command_palette = false;
+          assert(doCommand(s, cmd_id));
+          break;
+        }
+
+        Pos2 cursor = renderCommandPalette(tui, search, s->commands, s->menu_index);
+        tui->cursor.x = cursor.x;
+        tui->cursor.y = cursor.y;
+      } else {
+        if (input_buffer[0] == 'q' && input_buffer[1] == 0) {
+          assert(
+              doCommand(s, (u32)CommandQuit)
+              && "CommandQuit failed"
+          );
+        } else if (input_buffer[0] == '?') {
+          s->show_command_palette = true;
+          s->menu_index = 0;
+        } else if (left_arrow_pressed || input_buffer[0] == 'h') {
+          doCommand(s, (u32)CommandMoveToParent);
+        } else if (right_arrow_pressed || input_buffer[0] == 'l') {
+          doCommand(s, (u32)CommandMoveToFirstChild);
+        } else if (down_arrow_pressed || input_buffer[0] == 'j') {
+          if (selected->next_sibling != NODE_NIL) {
+            s->selected_node = selected->next_sibling;
+          }
+        } else if (up_arrow_pressed || input_buffer[0] == 'k') {
+          if (selected->prev_sibling != NODE_NIL) {
+            s->selected_node = selected->prev_sibling;
+          }
+        } else if (input_buffer[0] == 'I' && input_buffer[1] == 0) {
+          doCommand(s, (u32)CommandInsertSiblingBefore);
+        } else if (input_buffer[0] == 'i' && input_buffer[1] == 0) {
+          doCommand(s, (u32)CommandInsertSiblingAfter);
+        } else if (input_buffer[0] == 'd' && input_buffer[1] == 0) {
+          doCommand(s, (u32)CommandDeleteNode);
+        } else if (input_buffer[0] == 'u' && input_buffer[1] == 0) {
+          doCommand(s, (u32)CommandUndo);
+        } else if (input_buffer[0] == ASCII_CTRL_R && input_buffer[1] == 0) {
+          doCommand(s, (u32)CommandRedo);
+        } else if (input_buffer[0] == 'y' && input_buffer[1] == 0) {
+          doCommand(s, (u32)CommandYank);
+        } else if (input_buffer[0] == 'p' && input_buffer[1] == 0) {
+          doCommand(s, (u32)CommandPasteAfter);
+        } else if (input_buffer[0] == 'P' && input_buffer[1] == 0) {
+          doCommand(s, (u32)CommandPasteBefore);
+        } else if (input_buffer[0] == 'v' && input_buffer[1] == 0) {
+          doCommand(s, (u32)CommandSplitView);
+        } else if (input_buffer[0] == 'w' && input_buffer[1] == 0) {
+          doCommand(s, (u32)CommandNextView);
+        } else if (input_buffer[0] == 'c' && input_buffer[1] == 0) {
+          doCommand(s, (u32)CommandCloseView);
+        } else if (input_buffer[0] == 'e' && input_buffer[1] == 0) {
+          s->mode = ModeEdit;
+        } else if (input_buffer[0] == 'S' && input_buffer[1] == 0) {
+          /*
+          String data = {
+            .bytes = arenaAllocArray(&permanent_arena, u8, byte_count_of_file),
+            .capacity = byte_count_of_file,
+            .length = byte_count_of_file,
+          };
+          for (u32 i = 0; i < ROOM_TILE_COUNT; i++) {
+            data.bytes[i] = room.background[i];
+            data.bytes[i+ROOM_TILE_COUNT] = room.foreground[i];
+          }
+          if (FILE_EXISTED) {
+            osFileWrite(filename, data);
+          } else {
+            osFileCreateWrite(filename, data);
+          }
+          saved_on = osTimeMicrosecondsNow();
+          */
+        }
+      }
+    } break;
+    case ModeEdit: {
+      if (input_buffer[0] == ASCII_ESCAPE && input_buffer[1] == 0) {
+        s->mode = ModeNormal;
+        journalBreakRun(&s->journal); // the next session of typing undoes separately
+      }
+      // the selection may have changed since the top of the frame (e.g. via the command palette)
+      selected = nodeFromHandle(&s->tree, s->selected_node);
+      switch (selected->type) {
+        case NodeTypeIncomplete: {
+          // handle input
+          if (input_buffer[0] == 'f' && input_buffer[1] == 0) {
+            // a fresh function payload starts with an empty name and return type
+            journalChangeType(&s->journal, &s->tree, &s->string_arena, s->selected_node, NodeTypeFunction);
+          } else if (input_buffer[0] == 'r' && input_buffer[1] == 0) {
+            journalChangeType(&s->journal, &s->tree, &s->string_arena, s->selected_node, NodeTypeReturn);
+          }
+
+          // render
+          tui->frame_buffer[8].foreground = ANSI_HP_RED;
+          tui->frame_buffer[8].bytes[0] = 'f';
+          renderStrToBuffer(tui->frame_buffer, 9, 0, ": function", tui->screen_dimensions);
+          tui->frame_buffer[19].foreground = ANSI_HP_RED;
+          tui->frame_buffer[19].bytes[0] = 'r';
+          renderStrToBuffer(tui->frame_buffer, 20, 0, ": return", tui->screen_dimensions);
+        } break;
+        case NodeTypeFunction: {
+          CFnDetails* function = nodeFunction(&s->tree, selected);
+          // handle input
+          if (s->node_section == 0) { // editing fn declaration return type section
+            if (down_arrow_pressed) {
+              s->menu_index += 1;
+            } else if (up_arrow_pressed) {
+              s->menu_index -= 1;
+            } else if (tab_pressed || enter_pressed) {
+              PtrArray matching_types = listMatchingTypes(&scratch.arena, function->return_type);
+              //printf("%d", matching_types.length);
+              String temp = {
+                .bytes = matching_types.items[s->menu_index],
+                .length = strlen(matching_types.items[s->menu_index]),
+                .capacity = strlen(matching_types.items[s->menu_index]) + 1,
+              };
+              journalReplaceText(&s->journal, &s->tree, &s->string_arena, s->selected_node, TextFieldFunctionReturnType, temp);
+              s->menu_index = 0;
+              s->node_section += 1;
+            } else if (isAlphaUnderscoreSpace(input_buffer[0])) {
+              journalAppendText(&s->journal, &s->tree, &s->string_arena, s->selected_node, TextFieldFunctionReturnType, input_string);
+            } else if (backspace_pressed) {
+              journalDeleteText(&s->journal, &s->tree, &s->string_arena, s->selected_node, TextFieldFunctionReturnType);
+            }
+          } else if (s->node_section == 1) { // editing fn declaration identifier/name section
+            if (backspace_pressed) {
+              journalDeleteText(&s->journal, &s->tree, &s->string_arena, s->selected_node, TextFieldFunctionName);
+            } else if (enter_pressed || tab_pressed) {
+              function->arg_count += 1;
+              s->node_section += 1;
+            } else if (isSimplePrintable(input_buffer[0])) {
+              journalAppendText(&s->journal, &s->tree, &s->string_arena, s->selected_node, TextFieldFunctionName, input_string);
+            }
+          } else { // editing fn decl args list
+          }
+
+          // render
+          renderStrToBuffer(tui->frame_buffer, 8, 0, "Choose Function Return Type", tui->screen_dimensions);
+          renderStrToBuffer(tui->frame_buffer, 40, 0, "Name Function", tui->screen_dimensions);
+          if (s->node_section == 0) { // editing fn declaration return type section
+            tui->cursor.x = selected_at.x + function->return_type.total_size;
+            tui->cursor.y = selected_at.y;
+            PtrArray matching_types = listMatchingTypes(&scratch.arena, function->return_type);
+            u32 pos = selected_at.x + (tui->screen_dimensions.width * (selected_at.y+1));
+            u32 list_size = Min(matching_types.length, 5);
+            u32 goal_i = list_size;
+            if (s->menu_index > (list_size/2)) {
+              goal_i = Min(s->menu_index + (list_size/2), matching_types.length);
+            }
+            for (u32 i = goal_i - list_size; i < goal_i; i++) {
+              u32 row_pos = pos+((list_size - (goal_i - i))*tui->screen_dimensions.width);
+              for (u32 j = 0; j < 24; j++) {
+                if (s->menu_index == i) {
+                  tui->frame_buffer[row_pos+j].background = 230;
+                  tui->frame_buffer[row_pos+j].foreground = 33;
+                } else {
+                  tui->frame_buffer[row_pos+j].background = 33;
+                  tui->frame_buffer[row_pos+j].foreground = 230;
+                }
+                if (j < strlen(matching_types.items[i])) {
+                  tui->frame_buffer[row_pos+j].bytes[0] = matching_types.items[i][j];
+                } else {
+                  tui->frame_buffer[row_pos+j].bytes[0] = ' ';
+                }
+              }
+            }
+          } else if (s->node_section == 1) { // editing fn declaration identifier/name section
+            tui->cursor.x = selected_at.x + function->return_type.total_size + 1 + function->name.total_size;
+            tui->cursor.y = selected_at.y;
+            u32 pos = tui->cursor.x + (tui->screen_dimensions.width * (selected_at.y));
+            for (u32 i = 0; i < function->name.total_size; i++) {
+              tui->frame_buffer[pos+i].foreground = ANSI_DULL_GRAY;
+            }
+          }
+        } break;
+        case NodeTypeRoot: {
+          // TODO message that you can't edit the root node
+        } break;
+        case NodeTypeStatement:
+        case NodeTypeExpression:
+        case NodeTypeInvalid:
+        case NodeTypeReturn:
+        case NodeTypeNumericLiteral:
+        case NodeTypeBlock:
+        case NodeType_Count:
+          break;
+      }
+    } break;
+    case Mode_Count: {
+      printf("error");
+      s->should_quit = true;
+    } break;
+  }
+
+  scratchReturn(&scratch);
+  return s->should_quit;
+}
+
+// everything the editor starts with: one view over a tree holding `int main() { return 0; }`
+fn void editorInit(State* state) {
+  *state = (State){
+    .should_quit = false,
+    .pending_command = false,
+    .mode = ModeNormal,
+  };
+  arenaInit(&state->permanent_arena);
+
+  arenaInit(&state->string_arena.a);
+  state->string_arena.mutex = newMutex();
+
+  state->commands.length = Command_Count;
+  state->commands.items = arenaAllocArray(&state->permanent_arena, CommandPaletteCommand, state->commands.length);
+  for (u32 i = 0; i < state->commands.length; i++) {
+    state->commands.items[i] = COMMANDS[i];
+  }
+  state->cmd_palette_search_input = allocStringChunkList(&state->string_arena, EMPTY_STRING);
+
+  state->views.capacity = MAX_VIEWS;
+  arenaInit(&state->views.arena);
+  state->views.items = arenaAllocArray(&state->views.arena, View, state->views.capacity);
+  MemoryZero(state->views.items, state->views.capacity * sizeof(View));
+  state->tree = cTreeCreate();
+  state->layout = layoutCreate();
+  state->journal = journalCreate(JOURNAL_DEFAULT_MAX_BYTES);
+  state->clip = clipCreate();
+  state->views.length = 1;
+  state->views.items[0].root = state->tree.root;
+  state->views.items[0].cache = viewCacheCreate();
+
+  NodeHandle fn_handle = addNode(&state->tree, NodeTypeFunction, state->tree.root);
+  state->function_node = fn_handle;
+  state->selected_node = fn_handle;
+  CNode* fn_node = nodeFromHandle(&state->tree, fn_handle);
+  String main_fn_name = {
+    .bytes = "main",
+    .length = 4,
+    .capacity = 5,
+  };
+  CFnDetails* fn_details = nodeFunction(&state->tree, fn_node);
+  fn_details->name = allocStringChunkList(&state->string_arena, main_fn_name);
+  fn_details->return_type = allocStringChunkList(&state->string_arena, DEFAULT_RETURN_TYPE);
+
+  NodeHandle ret_handle = addNode(&state->tree, NodeTypeReturn, fn_handle);
+
+  CNode* ret_literal_node = nodeFromHandle(&state->tree, addNode(&state->tree, NodeTypeNumericLiteral, ret_handle));
+  String* ret_literal = nodeNumericLiteral(&state->tree, ret_literal_node);
+  ret_literal->bytes = "0";
+  ret_literal->length = 1;
+  ret_literal->capacity = 2;
+}
+
+// render_test.c includes this file to drive updateAndRender without a terminal
+#ifndef TREE_EDITOR_NO_MAIN
+i32 main(i32 argc, ptr argv[]) {
+  osInit();
+  ThreadContext tctx = {0};
+  tctxInit(&tctx);
+  State state;
+  editorInit(&state);
+
+  // ui loop (read input, simulate next frame, render)
+  infiniteUILoop(
+    MAX_SCREEN_WIDTH,
+    MAX_SCREEN_HEIGHT,
+    GOAL_INPUT_LOOP_US,
+    &state,
+    updateAndRender
+  );
+
+  return 0;
+}
+#endif
@@ -0,0 +1,170 @@
+#include "tree_store.h"
+
+fn StoreNode* storeNode(TreeStore* store, StoreRef ref) {
+  assert(ref < store->node_count);
+  return &store->nodes[ref];
+}
+
+fn StoreRef* storeChildren(TreeStore* store, StoreNode* node) {
+  return &store->child_refs[node->children];
+}
+
+fn u64 treeStoreBytesUsed(TreeStore* store) {
+  return (u64)store->node_count * sizeof(StoreNode) + store->child_ref_count * sizeof(StoreRef);
+}
+
+fn StoreRef storeAllocNode(TreeStore* store) {
+  if (store->node_count == store->node_capacity) {
+    arenaAllocArray(&store->node_arena, StoreNode, store->node_capacity); // extends `nodes` in place
+    store->node_capacity *= 2;
+  }
+  return store->node_count++;
+}
+
+fn u32 storeAllocChildRefs(TreeStore* store, u32 count) {
+  while (store->child_ref_count + count > store->child_ref_capacity) {
+    arenaAllocArray(&store->child_ref_arena, StoreRef, store->child_ref_capacity); // extends `child_refs` in place
+    store->child_ref_capacity *= 2;
+  }
+  assert(store->child_ref_count + count <= MAX_u32 && "TreeStore ran out of child refs");
+  u32 result = (u32)store->child_ref_count;
+  store->child_ref_count += count;
+  return result;
+}
+
+fn StoreRef storeRefFromId(TreeStore* store, u32 node_id) {
+  if (node_id >= store->id_capacity) return STORE_REF_NIL;
+  return store->ref_by_id[node_id];
+}
+
+fn void storeSetRef(TreeStore* store, u32 node_id, StoreRef ref) {
+  while (node_id >= store->id_capacity) {
+    arenaAllocArray(&store->id_arena, StoreRef, store->id_capacity); // extends `ref_by_id` in place
+    MemoryZero(store->ref_by_id + store->id_capacity, store->id_capacity * sizeof(StoreRef));
+    store->id_capacity *= 2;
+  }
+  store->ref_by_id[node_id] = ref;
+}
+
+// writes a fresh copy of `node` pointing at the latest version of each child.
+// children that were never committed (fresh inserts, whole pasted subtrees) get written first.
+fn StoreRef storeWriteNode(TreeStore* store, CTree* tree, CNode* node) {
+  u32 children = storeAllocChildRefs(store, node->child_count);
+  u32 i = 0;
+  for (NodeHandle h = node->first_child; h != NODE_NIL; i++) {
+    CNode* child = nodeFromHandle(tree, h);
+    StoreRef ref = storeRefFromId(store, child->id);
+    if (ref == STORE_REF_NIL) {
+      ref = storeWriteNode(store, tree, child);
+    }
+    store->child_refs[children + i] = ref;
+    h = child->next_sibling;
+  }
+  assert(i == node->child_count);
+
+  StoreRef result = storeAllocNode(store);
+  StoreNode* written = &store->nodes[result];
+  written->type = node->type;
+  written->id = node->id;
+  written->payload = node->payload;
+  written->children = children;
+  written->child_count = node->child_count;
+  storeSetRef(store, node->id, result);
+  return result;
+}
+
+// a copy of `parent` with `old_child` swapped for `new_child`; everything else is shared.
+// returns STORE_REF_NIL if `old_child` isn't there, i.e. the parent's own shape changed too.
+fn StoreRef storeReplaceChild(TreeStore* store, StoreRef parent, StoreRef old_child, StoreRef new_child) {
+  u32 child_count = store->nodes[parent].child_count;
+  u32 children = storeAllocChildRefs(store, child_count);
+  StoreRef* from = &store->child_refs[store->nodes[parent].children];
+  StoreRef* to = &store->child_refs[children];
+  bool found = false;
+  for (u32 i = 0; i < child_count; i++) {
+    to[i] = from[i];
+    if (from[i] == old_child) {
+      to[i] = new_child;
+      found = true;
+    }
+  }
+  if (!found) {
+    store->child_ref_count -= child_count;
+    return STORE_REF_NIL;
+  }
+
+  StoreRef result = storeAllocNode(store);
+  store->nodes[result] = store->nodes[parent];
+  store->nodes[result].children = children;
+  storeSetRef(store, store->nodes[result].id, result);
+  return result;
+}
+
+fn TreeStore treeStoreCreate(CTree* tree) {
+  TreeStore result = {
+    .node_count = 1, // node 0 is the nil node
+    .node_capacity = TREE_STORE_INITIAL_CAPACITY,
+    .child_ref_capacity = TREE_STORE_INITIAL_CAPACITY,
+    .id_capacity = TREE_STORE_INITIAL_CAPACITY,
+    .mutex = newMutex(),
+  };
+  arenaInitSized(&result.node_arena, TREE_STORE_MAX_BYTES);
+  result.nodes = arenaAllocArray(&result.node_arena, StoreNode, result.node_capacity);
+  MemoryZeroStruct(&result.nodes[STORE_REF_NIL], StoreNode);
+  arenaInitSized(&result.child_ref_arena, TREE_STORE_MAX_BYTES);
+  result.child_refs = arenaAllocArray(&result.child_ref_arena, StoreRef, result.child_ref_capacity);
+  arenaInitSized(&result.id_arena, (u64)(MAX_u32 / 2) * sizeof(StoreRef));
+  result.ref_by_id = arenaAllocArray(&result.id_arena, StoreRef, result.id_capacity);
+  MemoryZero(result.ref_by_id, result.id_capacity * sizeof(StoreRef));
+
+  result.root = storeWriteNode(&result, tree, nodeFromHandle(tree, tree->root));
+  result.version = 1;
+  return result;
+}
+
+fn void treeStoreRelease(TreeStore* store) {
+  arenaFree(&store->node_arena);
+  arenaFree(&store->child_ref_arena);
+  arenaFree(&store->id_arena);
+  MemoryZeroStruct(store, TreeStore);
+}
+
+// records the current type, payload and children of `handle` as a new version.
+// call it after every edit, on the node whose children changed (the parent, for an
+// insert or delete) or on the node itself (a type change). only that node and its
+// ancestors are copied, so an edit costs O(depth * fanout) refs, never O(tree).
+fn void treeStoreCommitNode(TreeStore* store, CTree* tree, NodeHandle handle) {
+  CNode* node = nodeFromHandle(tree, handle);
+  assert(node != &tree->nodes[NODE_NIL] && "committing a node that isn't in the tree");
+  StoreRef old_ref = storeRefFromId(store, node->id);
+  StoreRef new_ref = storeWriteNode(store, tree, node);
+  while (handle != tree->root) {
+    handle = node->parent;
+    node = nodeFromHandle(tree, handle);
+    assert(node != &tree->nodes[NODE_NIL] && "committing a node that isn't attached to the root");
+    StoreRef parent_ref = storeRefFromId(store, node->id);
+    StoreRef next_old_ref = parent_ref;
+    StoreRef next_new_ref = STORE_REF_NIL;
+    if (parent_ref != STORE_REF_NIL && old_ref != STORE_REF_NIL) {
+      next_new_ref = storeReplaceChild(store, parent_ref, old_ref, new_ref);
+    }
+    if (next_new_ref == STORE_REF_NIL) {
+      next_new_ref = storeWriteNode(store, tree, node);
+    }
+    old_ref = next_old_ref;
+    new_ref = next_new_ref;
+  }
+
+  // everything the new root reaches is written, so readers can have it now
+  lockMutex(&store->mutex);
+  store->root = new_ref;
+  store->version += 1;
+  unlockMutex(&store->mutex);
+}
+
+fn TreeSnapshot treeSnapshotTake(TreeStore* store) {
+  lockMutex(&store->mutex);
+  TreeSnapshot result = { .root = store->root, .version = store->version };
+  unlockMutex(&store->mutex);
+  return result;
+}
@@ -0,0 +1,344 @@
+#include "journal.h"
+
+fn StringChunkList* textFieldList(CTree* tree, CNode* node, TextField field) {
+  CFnDetails* function = nodeFunction(tree, node);
+  switch (field) {
+    case TextFieldFunctionName:
+      return &function->name;
+    case TextFieldFunctionReturnType:
+      return &function->return_type;
+    case TextField_Count:
+      break;
+  }
+  assert(0 && "unknown TextField");
+  return NULL;
+}
+
+fn u8 stringChunkListLastByte(StringChunkList* list) {
+  assert(list->total_size > 0);
+  return ((u8*)(list->last + 1))[(list->total_size - 1) % STRING_CHUNK_PAYLOAD_SIZE];
+}
+
+fn u64 journalEntryBytes(JournalEntry* entry) {
+  return sizeof(JournalEntry) + entry->text_length + entry->replacement_length + (u64)entry->node_count * sizeof(CNode);
+}
+
+fn u8* journalText(Journal* journal, JournalEntry* entry) {
+  return journal->text + (entry->text - journal->text_base);
+}
+
+fn Journal journalCreate(u64 max_bytes) {
+  Journal result = {
+    .max_bytes = max_bytes,
+    .capacity = JOURNAL_INITIAL_CAPACITY,
+    .text_capacity = JOURNAL_INITIAL_CAPACITY,
+  };
+  arenaInit(&result.entry_arena);
+  result.entries = arenaAllocArray(&result.entry_arena, JournalEntry, result.capacity);
+  arenaInit(&result.text_arena);
+  result.text = arenaAllocArray(&result.text_arena, u8, result.text_capacity);
+  return result;
+}
+
+// frees a subtree that only the journal was keeping alive
+fn void journalFreeDetached(CTree* tree, StringArena* strings, u32 node_id) {
+  NodeHandle handle = handleFromId(tree, node_id);
+  assert(handle != NODE_NIL && nodeFromHandle(tree, handle)->parent == NODE_NIL);
+  deleteSubtree(tree, handle, strings);
+}
+
+fn void journalRelease(Journal* journal, CTree* tree, StringArena* strings) {
+  for (u32 i = journal->first; i < journal->length; i++) {
+    JournalEntry* entry = &journal->entries[i];
+    bool done = i < journal->done;
+    if ((done && entry->op == JournalOpDeleteNode) || (!done && entry->op == JournalOpInsertNode)) {
+      journalFreeDetached(tree, strings, entry->node_id);
+    }
+  }
+  arenaFree(&journal->entry_arena);
+  arenaFree(&journal->text_arena);
+  MemoryZeroStruct(journal, Journal);
+}
+
+// a new edit makes everything that was undone unreachable
+fn void journalDropRedo(Journal* journal, CTree* tree, StringArena* strings) {
+  if (journal->done == journal->length) return;
+  journal->text_length = journal->entries[journal->done].text - journal->text_base;
+  // newest first, so an undone insert's undone children are gone before it is
+  for (u32 i = journal->length; i > journal->done; i--) {
+    JournalEntry* entry = &journal->entries[i - 1];
+    if (entry->op == JournalOpInsertNode) {
+      journalFreeDetached(tree, strings, entry->node_id);
+    }
+    journal->bytes_used -= journalEntryBytes(entry);
+  }
+  journal->length = journal->done;
+}
+
+// forgets the oldest history until the journal fits under max_bytes again
+fn void journalTrim(Journal* journal, CTree* tree, StringArena* strings) {
+  while (journal->bytes_used > journal->max_bytes && journal->first < journal->done) {
+    JournalEntry* entry = &journal->entries[journal->first];
+    if (entry->op == JournalOpDeleteNode) {
+      journalFreeDetached(tree, strings, entry->node_id);
+    }
+    journal->bytes_used -= journalEntryBytes(entry);
+    journal->first += 1;
+  }
+}
+
+fn JournalEntry* journalPush(Journal* journal, CTree* tree, StringArena* strings, JournalOp op, u32 node_id) {
+  journalDropRedo(journal, tree, strings);
+  if (journal->length == journal->capacity) {
+    if (journal->first >= journal->capacity / 2) {
+      // the trimmed front is at least half the array: slide the live part down instead of growing
+      u32 live = journal->length - journal->first;
+      MemoryCopy(journal->entries, journal->entries + journal->first, (u64)live * sizeof(JournalEntry));
+      journal->done -= journal->first;
+      journal->length = live;
+      journal->first = 0;
+    } else {
+      arenaAllocArray(&journal->entry_arena, JournalEntry, journal->capacity); // extends `entries` in place
+      journal->capacity *= 2;
+    }
+  }
+  JournalEntry* result = &journal->entries[journal->length++];
+  MemoryZeroStruct(result, JournalEntry);
+  result->op = op;
+  result->node_id = node_id;
+  result->text = journal->text_base + journal->text_length;
+  journal->done = journal->length;
+  journal->bytes_used += sizeof(JournalEntry);
+  journal->coalesce = false;
+  return result;
+}
+
+// makes room for `length` more bytes of text and returns where they go
+fn u8* journalReserveText(Journal* journal, u64 length) {
+  if (journal->text_length + length > journal->text_capacity) {
+    u64 dead = journal->first < journal->length
+      ? journal->entries[journal->first].text - journal->text_base
+      : journal->text_length;
+    if (dead >= journal->text_capacity / 2) {
+      // like entries, slide the live text down rather than growing past trimmed history
+      MemoryCopy(journal->text, journal->text + dead, journal->text_length - dead);
+      journal->text_base += dead;
+      journal->text_length -= dead;
+    }
+    while (journal->text_length + length > journal->text_capacity) {
+      arenaAllocArray(&journal->text_arena, u8, journal->text_capacity); // extends `text` in place
+      journal->text_capacity *= 2;
+    }
+  }
+  u8* result = journal->text + journal->text_length;
+  journal->text_length += length;
+  journal->bytes_used += length;
+  return result;
+}
+
+fn void journalPushText(Journal* journal, u8* bytes, u64 length) {
+  MemoryCopy(journalReserveText(journal, length), bytes, length);
+}
+
+fn void journalSetType(CTree* tree, StringArena* strings, NodeHandle handle, NodeType type) {
+  // a node that stops being a function gives its strings back; a new one starts with empty lists
+  releaseNodeStrings(tree, nodeFromHandle(tree, handle), strings);
+  changeNodeType(tree, handle, type);
+}
+
+fn void journalLink(CTree* tree, JournalEntry* entry) {
+  NodeHandle prev = entry->prev_id != 0 ? handleFromId(tree, entry->prev_id) : NODE_NIL;
+  linkNodeAfter(tree, handleFromId(tree, entry->parent_id), prev, handleFromId(tree, entry->node_id));
+}
+
+fn void journalSetText(StringArena* strings, StringChunkList* list, u8* bytes, u64 length) {
+  String string = { .bytes = (ptr)bytes, .length = length, .capacity = length };
+  releaseStringChunkList(strings, list);
+  *list = allocStringChunkList(strings, string);
+}
+
+// returns the id of the node the edit happened to, for the editor to put the cursor on
+fn u32 journalApply(Journal* journal, CTree* tree, StringArena* strings, JournalEntry* entry, bool undo) {
+  u32 result = entry->node_id;
+  NodeHandle handle = handleFromId(tree, entry->node_id);
+  switch ((JournalOp)entry->op) {
+    case JournalOpInsertNode:
+    case JournalOpDeleteNode: {
+      bool link = (entry->op == JournalOpInsertNode) != undo;
+      if (link) {
+        journalLink(tree, entry);
+      } else {
+        unlinkNode(tree, handle);
+        result = entry->prev_id != 0 ? entry->prev_id : entry->parent_id;
+      }
+    } break;
+    case JournalOpChangeType: {
+      journalSetType(tree, strings, handle, undo ? entry->old_type : entry->new_type);
+    } break;
+    case JournalOpAppendText:
+    case JournalOpDeleteText: {
+      StringChunkList* list = textFieldList(tree, nodeFromHandle(tree, handle), entry->field);
+      u8* text = journalText(journal, entry);
+      bool append = (entry->op == JournalOpAppendText) != undo;
+      if (!append) {
+        for (u32 i = 0; i < entry->text_length; i++) {
+          stringChunkListDeleteLast(strings, list);
+        }
+      } else if (entry->op == JournalOpAppendText) {
+        String string = { .bytes = (ptr)text, .length = entry->text_length, .capacity = entry->text_length };
+        stringChunkListAppend(strings, list, string);
+      } else {
+        // deleted bytes were recorded last-first
+        for (u32 i = entry->text_length; i > 0; i--) {
+          String string = { .bytes = (ptr)&text[i - 1], .length = 1, .capacity = 1 };
+          stringChunkListAppend(strings, list, string);
+        }
+      }
+      markNodeChanged(tree, handle);
+    } break;
+    case JournalOpReplaceText: {
+      StringChunkList* list = textFieldList(tree, nodeFromHandle(tree, handle), entry->field);
+      u8* text = journalText(journal, entry);
+      if (undo) {
+        journalSetText(strings, list, text, entry->text_length);
+      } else {
+        journalSetText(strings, list, text + entry->text_length, entry->replacement_length);
+      }
+      markNodeChanged(tree, handle);
+    } break;
+    case JournalOp_Count:
+      assert(0 && "unknown JournalOp");
+      break;
+  }
+  return result;
+}
+
+fn NodeHandle journalUndo(Journal* journal, CTree* tree, StringArena* strings) {
+  if (journal->done == journal->first) return NODE_NIL;
+  journal->coalesce = false;
+  journal->done -= 1;
+  u32 node_id = journalApply(journal, tree, strings, &journal->entries[journal->done], true);
+  return handleFromId(tree, node_id);
+}
+
+fn NodeHandle journalRedo(Journal* journal, CTree* tree, StringArena* strings) {
+  if (journal->done == journal->length) return NODE_NIL;
+  journal->coalesce = false;
+  journal->done += 1;
+  u32 node_id = journalApply(journal, tree, strings, &journal->entries[journal->done - 1], false);
+  return handleFromId(tree, node_id);
+}
+
+fn void journalBreakRun(Journal* journal) {
+  journal->coalesce = false;
+}
+
+fn void journalRecordPosition(JournalEntry* entry, CTree* tree, CNode* node) {
+  entry->parent_id = nodeFromHandle(tree, node->parent)->id;
+  // the nil node's id is 0, which is also the root's, but the root is never anyone's sibling
+  entry->prev_id = nodeFromHandle(tree, node->prev_sibling)->id;
+}
+
+// records a node, or a whole pasted subtree, that was just linked into the tree
+fn void journalRecordInsert(Journal* journal, CTree* tree, StringArena* strings, NodeHandle handle) {
+  CNode* node = nodeFromHandle(tree, handle);
+  JournalEntry* entry = journalPush(journal, tree, strings, JournalOpInsertNode, node->id);
+  journalRecordPosition(entry, tree, node);
+  for (NodeHandle h = handle; h != NODE_NIL; h = nextNodePreorder(tree, h, handle)) {
+    entry->node_count += 1; // what an undone insert keeps alive
+  }
+  journal->bytes_used += (u64)entry->node_count * sizeof(CNode);
+  journalTrim(journal, tree, strings);
+}
+
+fn NodeHandle journalInsertNode(Journal* journal, CTree* tree, StringArena* strings, NodeType type, NodeHandle parent, NodeHandle prev) {
+  NodeHandle result = prev != NODE_NIL
+    ? addNodeAfterSibling(tree, type, parent, prev)
+    : addNodeFirstChild(tree, type, parent);
+  journalRecordInsert(journal, tree, strings, result);
+  return result;
+}
+
+fn NodeHandle journalPaste(Journal* journal, CTree* tree, StringArena* strings, CTreeClip* clip, NodeHandle parent, NodeHandle prev) {
+  NodeHandle result = cTreePaste(tree, clip, strings, parent, prev);
+  journalRecordInsert(journal, tree, strings, result);
+  return result;
+}
+
+// unlinks the subtree; it's only freed once this entry can't be undone anymore
+fn void journalDeleteNode(Journal* journal, CTree* tree, StringArena* strings, NodeHandle handle) {
+  CNode* node = nodeFromHandle(tree, handle);
+  JournalEntry* entry = journalPush(journal, tree, strings, JournalOpDeleteNode, node->id);
+  journalRecordPosition(entry, tree, node);
+  for (NodeHandle h = handle; h != NODE_NIL; h = nextNodePreorder(tree, h, handle)) {
+    entry->node_count += 1;
+  }
+  journal->bytes_used += (u64)entry->node_count * sizeof(CNode);
+  unlinkNode(tree, handle);
+  journalTrim(journal, tree, strings);
+}
+
+fn void journalChangeType(Journal* journal, CTree* tree, StringArena* strings, NodeHandle handle, NodeType type) {
+  CNode* node = nodeFromHandle(tree, handle);
+  if (node->type == type) return;
+  JournalEntry* entry = journalPush(journal, tree, strings, JournalOpChangeType, node->id);
+  entry->old_type = node->type;
+  entry->new_type = type;
+  journalSetType(tree, strings, handle, type);
+  journalTrim(journal, tree, strings);
+}
+
+// the newest entry, if the next character edit of kind `op` may be folded into it
+fn JournalEntry* journalRunFor(Journal* journal, JournalOp op, u32 node_id, TextField field) {
+  if (!journal->coalesce || journal->done != journal->length || journal->done == journal->first) return NULL;
+  JournalEntry* top = &journal->entries[journal->done - 1];
+  if (top->op != op || top->node_id != node_id || top->field != field) return NULL;
+  return top;
+}
+
+fn void journalAppendText(Journal* journal, CTree* tree, StringArena* strings, NodeHandle handle, TextField field, String string) {
+  CNode* node = nodeFromHandle(tree, handle);
+  JournalEntry* entry = journalRunFor(journal, JournalOpAppendText, node->id, field);
+  if (entry == NULL) {
+    entry = journalPush(journal, tree, strings, JournalOpAppendText, node->id);
+    entry->field = field;
+  }
+  journalPushText(journal, (u8*)string.bytes, string.length);
+  entry->text_length += string.length;
+  stringChunkListAppend(strings, textFieldList(tree, node, field), string);
+  markNodeChanged(tree, handle);
+  journal->coalesce = true;
+  journalTrim(journal, tree, strings);
+}
+
+fn void journalDeleteText(Journal* journal, CTree* tree, StringArena* strings, NodeHandle handle, TextField field) {
+  CNode* node = nodeFromHandle(tree, handle);
+  StringChunkList* list = textFieldList(tree, node, field);
+  if (list->total_size == 0) return;
+  JournalEntry* entry = journalRunFor(journal, JournalOpDeleteText, node->id, field);
+  if (entry == NULL) {
+    entry = journalPush(journal, tree, strings, JournalOpDeleteText, node->id);
+    entry->field = field;
+  }
+  u8 deleted = stringChunkListLastByte(list);
+  journalPushText(journal, &deleted, 1);
+  entry->text_length += 1;
+  stringChunkListDeleteLast(strings, list);
+  markNodeChanged(tree, handle);
+  journal->coalesce = true;
+  journalTrim(journal, tree, strings);
+}
+
+fn void journalReplaceText(Journal* journal, CTree* tree, StringArena* strings, NodeHandle handle, TextField field, String string) {
+  CNode* node = nodeFromHandle(tree, handle);
+  StringChunkList* list = textFieldList(tree, node, field);
+  JournalEntry* entry = journalPush(journal, tree, strings, JournalOpReplaceText, node->id);
+  entry->field = field;
+  entry->text_length = (u32)list->total_size;
+  entry->replacement_length = (u32)string.length;
+  stringChunkCopyToBuffer(list, journalReserveText(journal, list->total_size), (u32)list->total_size);
+  journalPushText(journal, (u8*)string.bytes, string.length);
+  journalSetText(strings, list, (u8*)string.bytes, string.length);
+  markNodeChanged(tree, handle);
+  journalTrim(journal, tree, strings);
+}
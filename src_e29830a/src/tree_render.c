@@ -0,0 +1,551 @@
+#include "lib/tui.c"
+#include "c_tree.c"
+
+///// GLOBALS
+global const String DEFAULT_RETURN_TYPE = {
+  .bytes = "int",
+  .length = 3,
+  .capacity = 4,
+};
+
+global const String DEFAULT_FUNCTION_NAME = {
+  .bytes = "myFunction",
+  .length = 10,
+  .capacity = 11,
+};
+
+///// TYPES
+// where a node sits relative to its parent and how much room it and its children take,
+// in the same cells the renderers below draw. nodes the renderers skip (a return's
+// long literal) sit at their parent's corner with no size.
+typedef struct NodeLayout {
+  Pointu32 offset; // from the parent's top-left
+  u32 width;
+  u32 height;
+} NodeLayout;
+
+// the measured size and position of every node, by slot index. one per tree: layoutSync
+// re-measures just the nodes flagged NODE_FLAG_LAYOUT_DIRTY (an edited node and its
+// ancestors) and clears the flags, so an unchanged frame is a single flag check.
+typedef struct TreeLayout {
+  u32 capacity;
+  NodeLayout* nodes;
+  Arena arena;
+} TreeLayout;
+
+// one view's nodes in preorder, with the row each one starts on. preorder runs top to
+// bottom, so `tops` is sorted (each entry is a prefix sum of the heights above it) and
+// the node at any row is a binary search away. rebuilt from the layout, without
+// re-measuring anything, when the tree's content changes.
+typedef struct RowIndex {
+  u64 content_generation; // of the tree it was last built from
+  NodeHandle root;
+  u32 length;
+  u32 capacity;
+  NodeHandle* nodes;
+  u32* tops;
+  u32* open; // scratch for the build: tops of the ancestors still being walked
+  NodeHandle* path; // scratch for renderView
+  Arena arena;
+} RowIndex;
+
+// a window onto a view's rows. renderers draw in view coordinates through blitRun and
+// viewportText, which clip each run to the window once, so they never clip for themselves
+typedef struct Viewport {
+  Pixel* pixels; // width * height, pixels[0] is view cell (0, top)
+  u32 width;
+  u32 height;
+  u32 top;
+  TreeLayout* layout;
+  NodeHandle* path; // from the view root to the last node starting at or above `top`
+  u32 path_length;
+} Viewport;
+
+// cells copied into a viewport as they are, style and all
+typedef struct PixelRun {
+  Pixel* pixels;
+  u32 length;
+} PixelRun;
+
+// the keywords and punctuation the node renderers draw, styled once by glyphRunsInit
+typedef enum Glyph {
+  GlyphReturn,
+  GlyphParameters, // "() {" after a function's name
+  GlyphOpenBrace,
+  GlyphCloseBrace,
+  GlyphSemicolon,
+  GlyphIncomplete,
+  GlyphDefaultReturnType,
+  GlyphDefaultFunctionName,
+  Glyph_Count,
+} Glyph;
+
+// one view's visible rows, kept between frames. only re-rendered when the tree's
+// content_generation, the view's root, its scroll or its size move on, so drawing or
+// switching to an unchanged view is a row copy, and a re-render only visits the nodes
+// on screen.
+typedef struct ViewCache {
+  u64 content_generation; // of the tree it was last rendered from
+  NodeHandle root;
+  u32 scroll_row;
+  u32 width;
+  u32 height;
+  u32 pixel_capacity;
+  Pixel* pixels; // width * height
+  RowIndex rows;
+  Arena arena;
+} ViewCache;
+
+fn void renderNode(Viewport* vp, CTree* tree, NodeHandle handle, u32 x, u32 y, u32 depth);
+
+///// functions()
+global Pixel GLYPH_PIXELS[64];
+global PixelRun GLYPH_RUNS[Glyph_Count];
+global bool GLYPH_RUNS_READY = false;
+
+fn void glyphRunsInit() {
+  if (GLYPH_RUNS_READY) return;
+  struct { str text; u8 foreground; } glyphs[Glyph_Count] = {
+    [GlyphReturn] = { "return ", ANSI_HIGHLIGHT_YELLOW },
+    [GlyphParameters] = { "() {", 0 },
+    [GlyphOpenBrace] = { "{", 0 },
+    [GlyphCloseBrace] = { "}", 0 },
+    [GlyphSemicolon] = { ";", 0 },
+    [GlyphIncomplete] = { "____", 0 },
+    [GlyphDefaultReturnType] = { (str)DEFAULT_RETURN_TYPE.bytes, ANSI_DULL_GREEN },
+    [GlyphDefaultFunctionName] = { (str)DEFAULT_FUNCTION_NAME.bytes, ANSI_DULL_GRAY },
+  };
+  u32 used = 0;
+  for (u32 g = 0; g < Glyph_Count; g++) {
+    u32 length = strlen(glyphs[g].text);
+    assert(used + length <= arrayLen(GLYPH_PIXELS) && "GLYPH_PIXELS is too small for the glyphs");
+    GLYPH_RUNS[g] = (PixelRun){ .pixels = GLYPH_PIXELS + used, .length = length };
+    for (u32 i = 0; i < length; i++) {
+      GLYPH_PIXELS[used + i].bytes[0] = glyphs[g].text[i];
+      GLYPH_PIXELS[used + i].foreground = glyphs[g].foreground;
+    }
+    used += length;
+  }
+  GLYPH_RUNS_READY = true;
+}
+
+// the cells of row y from x on that are inside the viewport, at most `*length` of them.
+// NULL with `*length` 0 when none are
+fn Pixel* viewportRun(Viewport* vp, u32 x, u32 y, u32* length) {
+  if (x >= vp->width || y < vp->top || y - vp->top >= vp->height) {
+    *length = 0;
+    return NULL;
+  }
+  *length = Min(*length, vp->width - x);
+  return &vp->pixels[x + (y - vp->top) * vp->width];
+}
+
+// copies as much of `run` as fits into the viewport at (x, y)
+fn void blitRun(Viewport* vp, u32 x, u32 y, PixelRun run) {
+  u32 length = run.length;
+  Pixel* cells = viewportRun(vp, x, y, &length);
+  if (length > 0) {
+    MemoryCopy(cells, run.pixels, length * sizeof(Pixel));
+  }
+}
+
+fn void blitGlyph(Viewport* vp, u32 x, u32 y, Glyph glyph) {
+  blitRun(vp, x, y, GLYPH_RUNS[glyph]);
+}
+
+// text that's only known while rendering, in one color
+fn void viewportText(Viewport* vp, u32 x, u32 y, u8* bytes, u64 length, u8 foreground) {
+  u32 visible = Min(length, MAX_u32);
+  Pixel* cells = viewportRun(vp, x, y, &visible);
+  for (u32 i = 0; i < visible; i++) {
+    cells[i].foreground = foreground;
+    cells[i].bytes[0] = bytes[i];
+  }
+}
+
+fn void viewportStringChunkList(Viewport* vp, StringChunkList* list, u32 x, u32 y, u8 foreground) {
+  u32 visible = list->total_size;
+  Pixel* cells = viewportRun(vp, x, y, &visible);
+  StringChunk* chunk = list->first;
+  for (u32 i = 0; i < visible; i++) {
+    if (i > 0 && i % STRING_CHUNK_PAYLOAD_SIZE == 0) {
+      chunk = chunk->next;
+    }
+    cells[i].foreground = foreground;
+    cells[i].bytes[0] = *((char*)(chunk + 1) + (i%STRING_CHUNK_PAYLOAD_SIZE));
+  }
+}
+
+// a node's children, skipping the ones above and below the viewport. on the path to the
+// first visible row the walk starts at the path's next node: everything before it ends higher up
+fn void renderChildren(Viewport* vp, CTree* tree, NodeHandle handle, u32 x, u32 y, u32 depth) {
+  NodeHandle h = nodeFromHandle(tree, handle)->first_child;
+  if (depth + 1 < vp->path_length && vp->path[depth] == handle) {
+    h = vp->path[depth + 1];
+  }
+  for (; h != NODE_NIL; h = nodeFromHandle(tree, h)->next_sibling) {
+    NodeLayout* layout = &vp->layout->nodes[nodeHandleIndex(h)];
+    u32 child_y = y + layout->offset.y;
+    if (child_y >= vp->top + vp->height) break; // the rest are further down
+    if (child_y + layout->height > vp->top) {
+      renderNode(vp, tree, h, x + layout->offset.x, child_y, depth + 1);
+    }
+  }
+}
+
+// a short literal drawn on its parent's line, see layoutInlineLiteral
+fn void renderInlineLiteral(Viewport* vp, CTree* tree, CNode* node, u32 x, u32 y, u32 depth) {
+  CNode* child = nodeFromHandle(tree, node->first_child);
+  if (child->type == NodeTypeNumericLiteral && nodeNumericLiteral(tree, child)->length <= 6) {
+    u32 length = nodeNumericLiteral(tree, child)->length;
+    renderNode(vp, tree, node->first_child, x + 1, y, depth + 1);
+    blitGlyph(vp, x + 1 + length, y, GlyphSemicolon);
+  }
+}
+
+fn void renderFunctionNode(Viewport* vp, CTree* tree, NodeHandle handle, u32 x, u32 y, u32 depth) {
+  CNode* node = nodeFromHandle(tree, handle);
+  CFnDetails* function = nodeFunction(tree, node);
+  u32 column = x;
+
+  // print function's return type, colored green
+  if (function->return_type.total_size > 0) {
+    viewportStringChunkList(vp, &function->return_type, column, y, ANSI_HIGHLIGHT_GREEN);
+    column += function->return_type.total_size;
+  } else {
+    blitGlyph(vp, column, y, GlyphDefaultReturnType);
+    column += DEFAULT_RETURN_TYPE.length;
+  }
+  column += 1; // space
+  // print function's name
+  if (function->name.total_size > 0) {
+    viewportStringChunkList(vp, &function->name, column, y, 0);
+    column += function->name.total_size;
+  } else {
+    blitGlyph(vp, column, y, GlyphDefaultFunctionName);
+    column += DEFAULT_FUNCTION_NAME.length;
+  }
+  blitGlyph(vp, column, y, GlyphParameters);
+
+  renderChildren(vp, tree, handle, x, y, depth);
+
+  // print final closing brace, above the trailing empty line
+  u32 height = vp->layout->nodes[nodeHandleIndex(handle)].height;
+  blitGlyph(vp, x, y + height - 2, GlyphCloseBrace);
+}
+
+fn void renderNode(Viewport* vp, CTree* tree, NodeHandle handle, u32 x, u32 y, u32 depth) {
+  CNode* node = nodeFromHandle(tree, handle);
+  node->render_start.x = x;
+  node->render_start.y = y;
+
+  switch (node->type) {
+    case NodeTypeRoot: {
+      renderChildren(vp, tree, handle, x, y, depth);
+    } break;
+    case NodeTypeFunction: {
+      renderFunctionNode(vp, tree, handle, x, y, depth);
+    } break;
+    case NodeTypeReturn: {
+      blitGlyph(vp, x, y, GlyphReturn);
+      renderInlineLiteral(vp, tree, node, x + GLYPH_RUNS[GlyphReturn].length, y, depth);
+    } break;
+    case NodeTypeBlock: {
+      blitGlyph(vp, x, y, GlyphOpenBrace);
+      blitGlyph(vp, x, y + 1, GlyphCloseBrace);
+      renderInlineLiteral(vp, tree, node, x + 1, y, depth);
+    } break;
+    case NodeTypeNumericLiteral: {
+      String* literal = nodeNumericLiteral(tree, node);
+      viewportText(vp, x, y, literal->bytes, literal->length, ANSI_HIGHLIGHT_RED);
+    } break;
+    case NodeTypeIncomplete: {
+      // TODO render this with foreground ANSI_DULL_GRAY if the node is the currently selected node AND we are in insert mode
+      blitGlyph(vp, x, y, GlyphIncomplete);
+    } break;
+    case NodeTypeStatement:
+    case NodeTypeExpression:
+    case NodeTypeInvalid:
+    case NodeType_Count:
+      break;
+  }
+}
+
+fn RowIndex rowIndexCreate() {
+  RowIndex result = {
+    .content_generation = MAX_u64, // never matches a tree, so the first sync always builds
+  };
+  arenaInitSized(&result.arena, (u64)NODE_POOL_MAX_NODES * (2*sizeof(NodeHandle) + 2*sizeof(u32)) * 2);
+  return result;
+}
+
+fn void rowIndexRelease(RowIndex* index) {
+  arenaFree(&index->arena);
+  MemoryZeroStruct(index, RowIndex);
+}
+
+// rebuilds `index` for the subtree under `root` if the tree changed since the last call,
+// returns whether it did. `layout` has to be synced already
+fn bool rowIndexSync(RowIndex* index, CTree* tree, TreeLayout* layout, NodeHandle root) {
+  if (index->content_generation == tree->content_generation && index->root == root) {
+    return false;
+  }
+  u32 live = tree->length - 1 - tree->free_count;
+  if (live > index->capacity) {
+    arenaClear(&index->arena);
+    index->capacity = Max(live, index->capacity * 2);
+    index->nodes = arenaAllocArray(&index->arena, NodeHandle, index->capacity);
+    index->tops = arenaAllocArray(&index->arena, u32, index->capacity);
+    index->open = arenaAllocArray(&index->arena, u32, index->capacity);
+    index->path = arenaAllocArray(&index->arena, NodeHandle, index->capacity);
+  }
+
+  u32 count = 0;
+  u32 open_count = 0;
+  u32 top = 0;
+  NodeHandle handle = root;
+  while (handle != NODE_NIL) {
+    index->nodes[count] = handle;
+    index->tops[count] = top;
+    count += 1;
+
+    CNode* node = nodeFromHandle(tree, handle);
+    if (node->first_child != NODE_NIL) {
+      index->open[open_count++] = top;
+      handle = node->first_child;
+      top += layout->nodes[nodeHandleIndex(handle)].offset.y;
+      continue;
+    }
+    while (handle != root && node->next_sibling == NODE_NIL) {
+      handle = node->parent;
+      node = nodeFromHandle(tree, handle);
+      open_count -= 1;
+    }
+    if (handle == root) break;
+    handle = node->next_sibling;
+    top = index->open[open_count-1] + layout->nodes[nodeHandleIndex(handle)].offset.y;
+  }
+  index->length = count;
+  index->content_generation = tree->content_generation;
+  index->root = root;
+  return true;
+}
+
+// the last node in preorder that starts at or above `row`: the innermost node that's
+// open at that row, or the last one to end before it
+fn NodeHandle rowIndexFind(RowIndex* index, u32 row) {
+  u32 low = 0;
+  u32 high = index->length; // tops[0] is 0, so the answer is in [low, high)
+  while (high - low > 1) {
+    u32 mid = low + (high - low) / 2;
+    if (index->tops[mid] <= row) {
+      low = mid;
+    } else {
+      high = mid;
+    }
+  }
+  return index->nodes[low];
+}
+
+// renders the part of the subtree under `root` that's inside `vp`. with a row index the
+// walk jumps straight to the first visible row, without one it starts from the top
+fn void renderView(Viewport* vp, CTree* tree, NodeHandle root, RowIndex* rows) {
+  glyphRunsInit();
+  vp->path_length = 0;
+  if (rows != NULL && rows->length > 0) {
+    NodeHandle first = rowIndexFind(rows, vp->top);
+    for (NodeHandle h = first; h != root; h = nodeFromHandle(tree, h)->parent) {
+      vp->path_length += 1;
+    }
+    vp->path_length += 1;
+    vp->path = rows->path;
+    u32 depth = vp->path_length;
+    for (NodeHandle h = first; depth > 0; h = nodeFromHandle(tree, h)->parent) {
+      vp->path[--depth] = h;
+    }
+  }
+  renderNode(vp, tree, root, 0, 0, 0);
+}
+
+fn ViewCache viewCacheCreate() {
+  ViewCache result = {
+    .content_generation = MAX_u64, // never matches a tree, so the first sync always renders
+    .rows = rowIndexCreate(),
+  };
+  arenaInit(&result.arena);
+  return result;
+}
+
+fn void viewCacheRelease(ViewCache* cache) {
+  rowIndexRelease(&cache->rows);
+  arenaFree(&cache->arena);
+  MemoryZeroStruct(cache, ViewCache);
+}
+
+// re-renders the `width` x `height` window at `scroll_row` of the subtree under `root`
+// if anything changed since the last call, returns whether it did. `layout` has to be
+// synced already
+fn bool viewCacheSync(ViewCache* cache, CTree* tree, TreeLayout* layout, NodeHandle root, u32 scroll_row, u32 width, u32 height) {
+  if (cache->content_generation == tree->content_generation && cache->root == root
+      && cache->scroll_row == scroll_row && cache->width == width && cache->height == height) {
+    return false;
+  }
+  u32 pixel_count = width * height;
+  if (pixel_count > cache->pixel_capacity) {
+    arenaClear(&cache->arena);
+    cache->pixel_capacity = pixel_count;
+    cache->pixels = arenaAllocArray(&cache->arena, Pixel, pixel_count);
+  }
+  MemoryZero(cache->pixels, (u64)pixel_count * sizeof(Pixel));
+
+  // rebuilding the index is a walk over the whole view, which typing shouldn't pay for
+  // every keystroke: a frame where only the content changed walks from the top instead,
+  // and the index catches up the next time the view scrolls
+  bool moved = cache->root != root || cache->scroll_row != scroll_row || cache->height != height;
+  bool index_current = cache->rows.content_generation == tree->content_generation && cache->rows.root == root;
+  RowIndex* rows = NULL;
+  if (moved || index_current) {
+    rowIndexSync(&cache->rows, tree, layout, root);
+    rows = &cache->rows;
+  }
+  Viewport vp = {
+    .pixels = cache->pixels,
+    .width = width,
+    .height = height,
+    .top = scroll_row,
+    .layout = layout,
+  };
+  renderView(&vp, tree, root, rows);
+
+  cache->content_generation = tree->content_generation;
+  cache->root = root;
+  cache->scroll_row = scroll_row;
+  cache->width = width;
+  cache->height = height;
+  return true;
+}
+
+// copies the cached window into the frame at (x, y), clipped to the screen
+fn void viewCacheBlit(ViewCache* cache, TuiState* tui, u32 x, u32 y) {
+  Dim2 sd = tui->screen_dimensions;
+  if (x >= sd.width || y >= sd.height) return;
+  u32 width = Min(cache->width, sd.width - x);
+  u32 height = Min(cache->height, sd.height - y);
+  for (u32 row = 0; row < height; row++) {
+    MemoryCopy(
+      tui->frame_buffer + x + (y + row) * sd.width,
+      cache->pixels + row * cache->width,
+      width * sizeof(Pixel)
+    );
+  }
+}
+
+fn TreeLayout layoutCreate() {
+  TreeLayout result = { .capacity = NODE_POOL_INITIAL_CAPACITY };
+  arenaInitSized(&result.arena, (u64)NODE_POOL_MAX_NODES * sizeof(NodeLayout));
+  // the arena holds nothing else, so growing extends `nodes` in place and keeps what's measured
+  result.nodes = arenaAllocArray(&result.arena, NodeLayout, result.capacity);
+  return result;
+}
+
+fn void layoutRelease(TreeLayout* layout) {
+  arenaFree(&layout->arena);
+  MemoryZeroStruct(layout, TreeLayout);
+}
+
+// an inline literal, as return and block nodes draw it: after a space, then a ';'
+fn u32 layoutInlineLiteral(TreeLayout* layout, CTree* tree, CNode* node, u32 x) {
+  CNode* child = nodeFromHandle(tree, node->first_child);
+  if (child->type != NodeTypeNumericLiteral || nodeNumericLiteral(tree, child)->length > 6) {
+    return x;
+  }
+  layout->nodes[nodeHandleIndex(node->first_child)].offset = (Pointu32){ .x = x + 1 };
+  return x + 1 + nodeNumericLiteral(tree, child)->length + 1;
+}
+
+fn void layoutNode(TreeLayout* layout, CTree* tree, NodeHandle handle) {
+  CNode* node = nodeFromHandle(tree, handle);
+  if (!(node->flags & NODE_FLAG_LAYOUT_DIRTY)) return;
+  // children first: a node's size depends on theirs
+  for (NodeHandle h = node->first_child; h != NODE_NIL; h = nodeFromHandle(tree, h)->next_sibling) {
+    layoutNode(layout, tree, h);
+    layout->nodes[nodeHandleIndex(h)].offset = (Pointu32){0};
+  }
+
+  NodeLayout* result = &layout->nodes[nodeHandleIndex(handle)];
+  result->width = 0;
+  result->height = 0;
+  switch (node->type) {
+    case NodeTypeRoot: {
+      for (NodeHandle h = node->first_child; h != NODE_NIL; h = nodeFromHandle(tree, h)->next_sibling) {
+        NodeLayout* child = &layout->nodes[nodeHandleIndex(h)];
+        child->offset.y = result->height;
+        result->height += child->height;
+        result->width = Max(result->width, child->width);
+      }
+    } break;
+    case NodeTypeFunction: {
+      CFnDetails* function = nodeFunction(tree, node);
+      u64 return_type = function->return_type.total_size > 0 ? function->return_type.total_size : DEFAULT_RETURN_TYPE.length;
+      u64 name = function->name.total_size > 0 ? function->name.total_size : DEFAULT_FUNCTION_NAME.length;
+      result->width = return_type + 1 + name + 4; // "() {"
+      result->height = 1;
+      for (NodeHandle h = node->first_child; h != NODE_NIL; h = nodeFromHandle(tree, h)->next_sibling) {
+        NodeLayout* child = &layout->nodes[nodeHandleIndex(h)];
+        child->offset.x = 2;
+        child->offset.y = result->height;
+        result->height += child->height;
+        result->width = Max(result->width, 2 + child->width);
+      }
+      result->height += 2; // closing brace and a blank line
+    } break;
+    case NodeTypeReturn: {
+      result->width = layoutInlineLiteral(layout, tree, node, 7); // "return "
+      result->height = 1;
+    } break;
+    case NodeTypeBlock: {
+      result->width = layoutInlineLiteral(layout, tree, node, 1); // "{"
+      result->height = 1;
+    } break;
+    case NodeTypeNumericLiteral: {
+      result->width = nodeNumericLiteral(tree, node)->length;
+      result->height = 1;
+    } break;
+    case NodeTypeIncomplete: {
+      result->width = 4;
+      result->height = 1;
+    } break;
+    case NodeTypeStatement:
+    case NodeTypeExpression:
+    case NodeTypeInvalid:
+    case NodeType_Count:
+      break;
+  }
+  node->flags &= ~NODE_FLAG_LAYOUT_DIRTY;
+}
+
+// re-measures whatever changed since the last call, returns whether anything had
+fn bool layoutSync(TreeLayout* layout, CTree* tree) {
+  if (!(nodeFromHandle(tree, tree->root)->flags & NODE_FLAG_LAYOUT_DIRTY)) {
+    return false;
+  }
+  if (tree->length > layout->capacity) {
+    u32 capacity = Max(tree->length, layout->capacity * 2);
+    arenaAllocArray(&layout->arena, NodeLayout, capacity - layout->capacity);
+    layout->capacity = capacity;
+  }
+  layoutNode(layout, tree, tree->root);
+  return true;
+}
+
+// where `handle` sits relative to `root`, one of its ancestors
+fn Pointu32 layoutPosition(TreeLayout* layout, CTree* tree, NodeHandle handle, NodeHandle root) {
+  Pointu32 result = {0};
+  for (; handle != root; handle = nodeFromHandle(tree, handle)->parent) {
+    assert(handle != NODE_NIL && "root isn't an ancestor of the node");
+    Pointu32 offset = layout->nodes[nodeHandleIndex(handle)].offset;
+    result.x += offset.x;
+    result.y += offset.y;
+  }
+  return result;
+}
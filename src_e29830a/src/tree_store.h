@@ -0,0 +1,65 @@
+#ifndef TREE_STORE_H
+#define TREE_STORE_H
+
+#include "base/all.h"
+#include "c_tree.h"
+
+// a persistent (path-copying) mirror of a CTree's shape. StoreNodes are immutable
+// once written and only hold links downwards, so a version is just a root StoreRef:
+// committing an edit writes new copies of the edited node and its ancestors and
+// shares everything else with the previous version. taking a snapshot is O(1) and
+// a snapshot stays valid no matter what the writer does afterwards.
+//
+// NOTE: only the shape and node types are versioned. `payload` still indexes the
+// live CTree's payload tables, so snapshot readers see payload edits as they land.
+#define TREE_STORE_MAX_BYTES GB(8llu)
+#define TREE_STORE_INITIAL_CAPACITY (1024)
+#define STORE_REF_NIL (0)
+
+///// TYPES
+typedef u32 StoreRef; // index into TreeStore.nodes
+
+typedef struct StoreNode {
+  u8 type; // NodeType
+  u32 id;
+  u32 payload;
+  u32 children; // index into TreeStore.child_refs of this node's first child
+  u32 child_count;
+} StoreNode;
+
+typedef struct TreeStore {
+  // append-only: written by one thread, readable from any thread holding a snapshot
+  StoreNode* nodes; // node 0 is a zeroed nil node
+  u32 node_count;
+  u32 node_capacity;
+  Arena node_arena;
+  StoreRef* child_refs;
+  u64 child_ref_count;
+  u64 child_ref_capacity;
+  Arena child_ref_arena;
+
+  // writer-only: where each id lives in the latest version
+  StoreRef* ref_by_id;
+  u32 id_capacity;
+  Arena id_arena;
+
+  Mutex mutex; // guards `root`/`version` so readers never see a half-published version
+  StoreRef root;
+  u64 version;
+} TreeStore;
+
+typedef struct TreeSnapshot {
+  StoreRef root;
+  u64 version;
+} TreeSnapshot;
+
+///// Functions()
+fn TreeStore treeStoreCreate(CTree* tree);
+fn void treeStoreRelease(TreeStore* store);
+fn void treeStoreCommitNode(TreeStore* store, CTree* tree, NodeHandle handle);
+fn TreeSnapshot treeSnapshotTake(TreeStore* store);
+fn StoreNode* storeNode(TreeStore* store, StoreRef ref);
+fn StoreRef* storeChildren(TreeStore* store, StoreNode* node);
+fn u64 treeStoreBytesUsed(TreeStore* store);
+
+#endif //TREE_STORE_H